@@ -0,0 +1,40 @@
+#include "command_line.h"
+
+AppCommandLine::AppCommandLine()
+    : showOption("show", "显示主窗口"), startOption("start", "开始计时"),
+      pauseOption("pause", "暂停计时"),
+      themeOption("theme", "设置本次工作主题", "text"),
+      rebuildStatsOption("rebuild-stats",
+                         "从原始历史重新计算统计汇总后退出"),
+      reportOption("report", "生成报告后退出（weekly或monthly）", "period"),
+      formatOption("format", "报告格式（md或html）", "format", "md"),
+      outputOption("output", "报告输出目录", "dir", "."),
+      dataDirOption("data-dir", "统计数据目录，可重复指定以批量生成", "dir"),
+      soakOption("soak", "浸泡测试：加速运行指定天数的周期后退出", "days"),
+      soakReportOption("soak-report", "浸泡测试报告的输出路径", "file",
+                       "soak-report.json") {
+  parser.addOption(showOption);
+  parser.addOption(startOption);
+  parser.addOption(pauseOption);
+  parser.addOption(themeOption);
+  parser.addOption(rebuildStatsOption);
+  parser.addOption(reportOption);
+  parser.addOption(formatOption);
+  parser.addOption(outputOption);
+  parser.addOption(dataDirOption);
+  parser.addOption(soakOption);
+  parser.addOption(soakReportOption);
+}
+
+bool AppCommandLine::parse(const QStringList &arguments) {
+  return parser.parse(arguments);
+}
+
+bool AppCommandLine::hasTimerCommand() const {
+  return showRequested() || startRequested() || pauseRequested() ||
+         hasTheme();
+}
+
+bool AppCommandLine::isHeadless() const {
+  return rebuildStatsRequested() || reportRequested();
+}
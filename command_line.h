@@ -0,0 +1,57 @@
+#ifndef COMMAND_LINE_H
+#define COMMAND_LINE_H
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QStringList>
+
+// 命令行参数：启动时使用，也用于解析第二个实例转发过来的参数
+class AppCommandLine {
+public:
+  AppCommandLine();
+
+  bool parse(const QStringList &arguments);
+  QString errorText() const { return parser.errorText(); }
+
+  // 发给正在运行的实例的命令
+  bool showRequested() const { return parser.isSet(showOption); }
+  bool startRequested() const { return parser.isSet(startOption); }
+  bool pauseRequested() const { return parser.isSet(pauseOption); }
+  bool hasTheme() const { return parser.isSet(themeOption); }
+  QString theme() const { return parser.value(themeOption); }
+  bool hasTimerCommand() const;
+
+  // 无界面命令：执行后直接退出，不创建窗口
+  bool rebuildStatsRequested() const {
+    return parser.isSet(rebuildStatsOption);
+  }
+  bool isHeadless() const;
+
+  // 批量生成报告：每个--data-dir是一个用户的数据目录，未指定时使用本机数据
+  bool reportRequested() const { return parser.isSet(reportOption); }
+  QString reportPeriod() const { return parser.value(reportOption); }
+  QString reportFormat() const { return parser.value(formatOption); }
+  QString outputDir() const { return parser.value(outputOption); }
+  QStringList dataDirs() const { return parser.values(dataDirOption); }
+
+  // 浸泡测试：以加速的时间运行指定天数的番茄钟周期，输出资源占用报告
+  bool soakRequested() const { return parser.isSet(soakOption); }
+  int soakDays() const { return parser.value(soakOption).toInt(); }
+  QString soakReportPath() const { return parser.value(soakReportOption); }
+
+private:
+  QCommandLineParser parser;
+  QCommandLineOption showOption;
+  QCommandLineOption startOption;
+  QCommandLineOption pauseOption;
+  QCommandLineOption themeOption;
+  QCommandLineOption rebuildStatsOption;
+  QCommandLineOption reportOption;
+  QCommandLineOption formatOption;
+  QCommandLineOption outputOption;
+  QCommandLineOption dataDirOption;
+  QCommandLineOption soakOption;
+  QCommandLineOption soakReportOption;
+};
+
+#endif // COMMAND_LINE_H
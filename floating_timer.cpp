@@ -1,24 +1,77 @@
 #include "floating_timer.h"
+#include "frame_renderer.h"
+#include "state_file.h"
 #include <QApplication>
-#include <QFont>
+#include <QCryptographicHash>
 #include <QPainter>
 #include <QScreen>
 #include <QSettings>
+#include <QWindow>
+
+namespace {
+
+const int SaveDelayMs = 500; // 拖动停止后多久保存位置
+const qreal MinScale = 0.5;
+const char *LegacyPosKey = "FloatingTimer/windowPos"; // 旧版本的单一位置
+const char *LockedKey = "FloatingTimer/locked";
+
+// Qt 6始终启用高DPI缩放，逻辑尺寸已经按屏幕换算，帧也按devicePixelRatio渲染，
+// 这里不再按DPI放大，只在小屏幕上缩小：最多占可用区域的一半
+qreal screenScale(QScreen *screen) {
+  const QSize base = FrameRenderer::floatingBaseSize();
+  const QRect available = screen->availableGeometry();
+  const qreal scale =
+      qMin(1.0, qMin(available.width() * 0.5 / base.width(),
+                     available.height() * 0.5 / base.height()));
+  return qMax(scale, MinScale);
+}
+
+} // namespace
 
 FloatingTimer::FloatingTimer(QWidget *parent)
     : QWidget(parent), timer(new QTimer(this)), isWorkPhase(true),
-      isDragging(false), workDuration(25 * 60), breakDuration(5 * 60) {
+      isDarkTheme(true), isDragging(false), workDuration(25 * 60),
+      breakDuration(5 * 60), frameRenderer(nullptr),
+      saveTimer(new QTimer(this)), primaryIndex(-1), locked(false) {
+  // 默认接收鼠标，可以拖动；锁定后才让鼠标穿透
   setWindowFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::Tool |
-                 Qt::WindowDoesNotAcceptFocus | Qt::WindowTransparentForInput |
-                 Qt::Window);
+                 Qt::WindowDoesNotAcceptFocus | Qt::Window);
   setAttribute(Qt::WA_TranslucentBackground);
 
-  // 设置窗口大小 - 超大字体显示
-  setFixedSize(400, 200);
+  // 设置窗口大小 - 超大字体显示，按所在屏幕的大小缩放
+  setFixedSize(FrameRenderer::floatingBaseSize());
+
+  // 窗口被拖到另一块屏幕时按那块屏幕调整尺寸
+  create();
+  connect(windowHandle(), &QWindow::screenChanged, this,
+          &FloatingTimer::onScreensChanged, Qt::QueuedConnection);
+
+  // 屏幕增减时刷新缓存并切换到对应布局的位置。
+  // 排队处理：信号发出时屏幕列表和窗口位置可能还没有更新完
+  for (QScreen *screen : QGuiApplication::screens()) {
+    watchScreen(screen);
+  }
+  connect(qApp, &QGuiApplication::screenAdded, this, [this](QScreen *screen) {
+    watchScreen(screen);
+    QMetaObject::invokeMethod(this, &FloatingTimer::onScreensChanged,
+                              Qt::QueuedConnection);
+  });
+  connect(qApp, &QGuiApplication::screenRemoved, this,
+          &FloatingTimer::onScreensChanged, Qt::QueuedConnection);
+  connect(qApp, &QGuiApplication::primaryScreenChanged, this,
+          &FloatingTimer::onScreensChanged, Qt::QueuedConnection);
+  refreshScreens();
+
+  saveTimer->setSingleShot(true);
+  saveTimer->setInterval(SaveDelayMs);
+  connect(saveTimer, &QTimer::timeout, this, &FloatingTimer::savePosition);
 
   // 尝试加载保存的位置，如果没有则移动到屏幕左上角
   loadPosition();
 
+  QSettings settings(StateFile::path(), StateFile::format());
+  setLocked(settings.value(LockedKey, false).toBool());
+
   timer->setInterval(1000);
   connect(timer, &QTimer::timeout, this, &FloatingTimer::updateTimer);
 
@@ -27,6 +80,11 @@ FloatingTimer::FloatingTimer(QWidget *parent)
 
 FloatingTimer::~FloatingTimer() {}
 
+void FloatingTimer::setFrameRenderer(FrameRenderer *renderer) {
+  frameRenderer = renderer;
+  update();
+}
+
 void FloatingTimer::updateTimer() {
   if (remainingTime > QTime(0, 0)) {
     remainingTime = remainingTime.addSecs(-1);
@@ -44,6 +102,14 @@ void FloatingTimer::setWorkPhase(bool isWork) {
   update();
 }
 
+void FloatingTimer::setDarkTheme(bool dark) {
+  if (isDarkTheme == dark) {
+    return;
+  }
+  isDarkTheme = dark;
+  update();
+}
+
 void FloatingTimer::startTimer() { timer->start(); }
 
 void FloatingTimer::stopTimer() { timer->stop(); }
@@ -64,42 +130,38 @@ void FloatingTimer::resetTimer(int workDur, int breakDur, bool phase) {
 void FloatingTimer::paintEvent(QPaintEvent *event) {
   Q_UNUSED(event)
 
-  QPainter painter(this);
-  painter.setRenderHint(QPainter::Antialiasing);
-
-  // 绘制半透明黑色背景
-  painter.setBrush(QColor(0, 0, 0, 200));
-  painter.setPen(Qt::NoPen);
-  painter.drawRoundedRect(rect(), 15, 15);
-
-  // 设置超大字体
-  QFont font("Arial", 120, QFont::Bold);
-  painter.setFont(font);
+  FrameState state;
+  state.remainingSeconds = QTime(0, 0).secsTo(remainingTime);
+  state.totalSeconds = isWorkPhase ? workDuration : breakDuration;
+  state.isWorkPhase = isWorkPhase;
+  state.isDarkTheme = isDarkTheme;
 
-  // 根据阶段设置颜色
-  if (isWorkPhase) {
-    painter.setPen(QColor(255, 100, 100)); // 工作阶段红色
-  } else {
-    painter.setPen(QColor(100, 255, 100)); // 休息阶段绿色
+  QPainter painter(this);
+  if (!frameRenderer) {
+    painter.drawImage(0, 0,
+                      FrameRenderer::render(FrameRenderer::FloatingFrame,
+                                            state, size(), devicePixelRatioF()));
+    return;
   }
 
-  // 绘制时间文本（显示分钟和秒数，格式：mm:ss）
-  QString timeText = remainingTime.toString("mm:ss");
-  painter.drawText(rect(), Qt::AlignCenter, timeText);
-
-  // 绘制小文本显示阶段信息
-  QFont smallFont("Arial", 16, QFont::Normal);
-  painter.setFont(smallFont);
-  painter.setPen(Qt::white);
+  // 只贴上后台线程已经画好的帧，然后请求渲染接下来的帧
+  frameRenderer->setFloatingGeometry(size(), devicePixelRatioF());
+  painter.drawImage(0, 0,
+                    frameRenderer->frame(FrameRenderer::FloatingFrame, state));
+  frameRenderer->prefetch(FrameRenderer::FloatingFrame, state);
+}
 
-  QString phaseText = isWorkPhase ? "工作阶段" : "休息阶段";
-  QRect phaseRect(10, 10, width() - 20, 30);
-  painter.drawText(phaseRect, Qt::AlignLeft | Qt::AlignTop, phaseText);
+void FloatingTimer::setLocked(bool lock) {
+  if (lock == locked) {
+    return;
+  }
+  locked = lock;
+  isDragging = false;
+  // 直接修改已创建的原生窗口的标志，不重建窗口，屏幕变化的连接保持有效
+  windowHandle()->setFlag(Qt::WindowTransparentForInput, locked);
 
-  // 绘制时间格式提示
-  QString formatText = remainingTime.toString("mm:ss");
-  QRect formatRect(10, height() - 40, width() - 20, 30);
-  painter.drawText(formatRect, Qt::AlignLeft | Qt::AlignBottom, formatText);
+  QSettings settings(StateFile::path(), StateFile::format());
+  settings.setValue(LockedKey, locked);
 }
 
 void FloatingTimer::mousePressEvent(QMouseEvent *event) {
@@ -118,26 +180,155 @@ void FloatingTimer::mouseMoveEvent(QMouseEvent *event) {
   }
 }
 
+void FloatingTimer::moveEvent(QMoveEvent *event) {
+  QWidget::moveEvent(event);
+  // 拖动过程中不断移动，停下来之后才写入一次。
+  // 恢复位置时的移动事件可能稍后才由窗口系统送达，按位置而不是标志判断
+  if (isVisible() && pos() != storedPos) {
+    saveTimer->start();
+  }
+}
+
+void FloatingTimer::watchScreen(QScreen *screen) {
+  connect(screen, &QScreen::geometryChanged, this,
+          &FloatingTimer::onScreensChanged, Qt::QueuedConnection);
+  connect(screen, &QScreen::availableGeometryChanged, this,
+          &FloatingTimer::onScreensChanged, Qt::QueuedConnection);
+}
+
+void FloatingTimer::refreshScreens() {
+  screens.clear();
+  primaryIndex = -1;
+
+  QStringList layout;
+  const QScreen *primary = QGuiApplication::primaryScreen();
+  for (QScreen *screen : QGuiApplication::screens()) {
+    if (screen == primary) {
+      primaryIndex = screens.size();
+    }
+    const QRect geometry = screen->geometry();
+    screens.append({geometry, screen->availableGeometry(), screenScale(screen)});
+    layout << QString("%1@%2,%3,%4x%5")
+                  .arg(screen->name())
+                  .arg(geometry.x())
+                  .arg(geometry.y())
+                  .arg(geometry.width())
+                  .arg(geometry.height());
+  }
+  if (primaryIndex < 0 && !screens.isEmpty()) {
+    primaryIndex = 0;
+  }
+
+  // 同一组显示器按同样的方式排列时得到同一个布局
+  layout.sort();
+  layoutKey = QString::fromLatin1(
+      QCryptographicHash::hash(layout.join('|').toUtf8(),
+                               QCryptographicHash::Md5)
+          .toHex()
+          .left(16));
+}
+
+void FloatingTimer::onScreensChanged() {
+  const QString previous = layoutKey;
+  refreshScreens();
+  if (layoutKey == previous) {
+    // 只是可用区域变化，或者窗口换到了另一块屏幕
+    applyScale(screenAt(frameGeometry().center()));
+    return;
+  }
+
+  // 布局切换时系统可能已经挪动过窗口，这个位置不属于任何一个布局
+  saveTimer->stop();
+  loadPosition();
+}
+
+int FloatingTimer::screenAt(const QPoint &point) const {
+  for (int i = 0; i < screens.size(); ++i) {
+    if (screens[i].geometry.contains(point)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int FloatingTimer::screenForWindowAt(const QPoint &topLeft) const {
+  for (int i = 0; i < screens.size(); ++i) {
+    if (screens[i].geometry.contains(QRect(topLeft, scaledSize(i)).center())) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+QSize FloatingTimer::scaledSize(int screenIndex) const {
+  return (QSizeF(FrameRenderer::floatingBaseSize()) *
+          screens[screenIndex].scale)
+      .toSize();
+}
+
+void FloatingTimer::applyScale(int screenIndex) {
+  if (screenIndex < 0) {
+    screenIndex = primaryIndex;
+  }
+  if (screenIndex < 0) {
+    return;
+  }
+  const QSize scaled = scaledSize(screenIndex);
+  if (scaled != size()) {
+    setFixedSize(scaled); // 帧渲染器在下一次绘制时按新尺寸重新渲染
+  }
+}
+
+QString FloatingTimer::profileKey() const {
+  return "FloatingTimer/layouts/" + layoutKey;
+}
+
 void FloatingTimer::moveToDefaultPosition() {
-  // 移动到屏幕左上角
-  move(20, 80); // 左上角位置
+  // 移动到主屏幕可用区域的左上角
+  applyScale(primaryIndex);
+  const QRect available =
+      primaryIndex >= 0 ? screens[primaryIndex].available : QRect();
+  storedPos = available.topLeft() + QPoint(20, 20);
+  move(storedPos);
   savePosition();
 }
 
 void FloatingTimer::savePosition() {
-  QSettings settings("QtPomodoro", "FloatingTimer");
-  settings.setValue("windowPos", pos());
+  // 只写入位置，尺寸只在恢复位置和屏幕变化时调整
+  saveTimer->stop();
+  storedPos = pos();
+  QSettings settings(StateFile::path(), StateFile::format());
+  settings.setValue(profileKey() + "/pos", storedPos);
 }
 
 void FloatingTimer::loadPosition() {
-  QSettings settings("QtPomodoro", "FloatingTimer");
-  QPoint savedPos = settings.value("windowPos").toPoint();
+  QSettings settings(StateFile::path(), StateFile::format());
+  QVariant saved = settings.value(profileKey() + "/pos");
+  const bool migrated = !saved.isValid() && settings.contains(LegacyPosKey);
+  if (migrated) {
+    // 旧版本的单一位置只用来初始化第一个布局，之后由各布局的位置代替
+    saved = settings.value(LegacyPosKey);
+    settings.remove(LegacyPosKey);
+  }
 
-  if (savedPos.isNull()) {
-    // 如果没有保存的位置，移动到屏幕左上角
+  const QPoint savedPos = saved.toPoint();
+  const int index = saved.isValid() ? screenForWindowAt(savedPos) : -1;
+  if (index < 0) {
+    // 没有保存的位置，或者保存的位置已经不在任何屏幕上
     moveToDefaultPosition();
-  } else {
-    move(savedPos);
+    return;
+  }
+
+  // 缩放后窗口仍要完整地留在屏幕的可用区域内
+  saveTimer->stop();
+  applyScale(index);
+  const QRect available = screens[index].available;
+  storedPos = QPoint(
+      qBound(available.left(), savedPos.x(), available.right() - width() + 1),
+      qBound(available.top(), savedPos.y(), available.bottom() - height() + 1));
+  move(storedPos);
+  if (migrated) {
+    savePosition();
   }
 }
 
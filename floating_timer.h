@@ -7,6 +7,11 @@
 #include <QSettings>
 #include <QCloseEvent>
 #include <QMouseEvent>
+#include <QRect>
+#include <QVector>
+
+class FrameRenderer;
+class QScreen;
 
 class FloatingTimer : public QWidget
 {
@@ -16,6 +21,13 @@ public:
     explicit FloatingTimer(QWidget *parent = nullptr);
     ~FloatingTimer();
 
+    // 使用后台渲染好的帧绘制，未设置时在paintEvent中同步绘制
+    void setFrameRenderer(FrameRenderer *renderer);
+
+    // 锁定后鼠标穿透窗口，不能拖动；设置会保存
+    void setLocked(bool lock);
+    bool isLocked() const { return locked; }
+
 public slots:
     void updateTimer();
     void setTime(const QTime &time);
@@ -26,21 +38,50 @@ public slots:
     void moveToDefaultPosition();
     void savePosition();
     void loadPosition();
+    void setDarkTheme(bool dark); // 主题变化时只切换配色并重绘
 
 protected:
     void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
+    void moveEvent(QMoveEvent *event) override;
     void closeEvent(QCloseEvent *event) override;
 
+private slots:
+    void onScreensChanged();
+
 private:
+    // 缓存的屏幕信息，只在屏幕增减或变化时刷新
+    struct ScreenInfo {
+        QRect geometry;
+        QRect available;
+        qreal scale; // 小屏幕上的缩小比例，DPI由Qt的高DPI缩放处理
+    };
+
+    void watchScreen(QScreen *screen);
+    void refreshScreens();
+    int screenAt(const QPoint &point) const; // 不在任何屏幕上时返回-1
+    // 左上角在topLeft时窗口（按各屏幕缩放后）的中心所在的屏幕
+    int screenForWindowAt(const QPoint &topLeft) const;
+    QSize scaledSize(int screenIndex) const;
+    void applyScale(int screenIndex);
+    QString profileKey() const; // 当前屏幕布局的位置配置
+
     QTimer *timer;
     QTime remainingTime;
     bool isWorkPhase;
+    bool isDarkTheme;
     bool isDragging;
     QPoint dragPosition;
     int workDuration;
     int breakDuration;
+    FrameRenderer *frameRenderer;
+    QTimer *saveTimer; // 拖动时延迟保存位置
+    QVector<ScreenInfo> screens;
+    int primaryIndex;
+    QString layoutKey;
+    QPoint storedPos; // 最近一次保存或恢复的位置，移动到这里时不需要再保存
+    bool locked;      // 鼠标穿透，不能拖动
 };
 
 #endif // FLOATING_TIMER_H
\ No newline at end of file
@@ -0,0 +1,260 @@
+#include "frame_renderer.h"
+#include <QFont>
+#include <QFontDatabase>
+#include <QMutexLocker>
+#include <QPainter>
+
+namespace {
+
+const QSize TraySize(250, 80); // 托盘图标尺寸，更长的图标提供更大显示空间
+const int MaxCachedFrames = 32;
+
+QString timeText(int seconds) {
+  return QString("%1:%2")
+      .arg(seconds / 60, 2, 10, QChar('0'))
+      .arg(seconds % 60, 2, 10, QChar('0'));
+}
+
+void paintTray(QPainter &painter, const QSize &size, const FrameState &state) {
+  // 计算进度百分比
+  int progress = 100 - (state.remainingSeconds * 100) / state.totalSeconds;
+
+  // 绘制左侧圆圈进度条
+  int circleSize = 40;
+  int circleX = 2;
+  int circleY = (size.height() - circleSize) / 2;
+
+  // 绘制圆圈背景
+  painter.setBrush(state.isDarkTheme ? Qt::darkGray : Qt::lightGray);
+  painter.setPen(Qt::NoPen);
+  painter.drawEllipse(circleX, circleY, circleSize, circleSize);
+
+  // 绘制进度弧线
+  painter.setPen(QPen(state.isDarkTheme ? Qt::white : Qt::black, 3));
+  int startAngle = 90 * 16;                   // 从12点开始
+  int spanAngle = -progress * 360 / 100 * 16; // 顺时针绘制
+  painter.drawArc(circleX + 2, circleY + 2, circleSize - 4, circleSize - 4,
+                  startAngle, spanAngle);
+
+  // 在圆圈右侧绘制时间文本（只显示分钟数）
+  painter.setPen(state.isDarkTheme ? Qt::white : Qt::black);
+  QFont font("Arial", 100, QFont::Bold);
+  painter.setFont(font);
+
+  QString text = QString::number(state.remainingSeconds / 60 % 60);
+  QRect textRect(circleSize + 15, 0, size.width() - circleSize - 15,
+                 size.height());
+  painter.drawText(textRect, Qt::AlignCenter, text);
+}
+
+void paintFloating(QPainter &painter, const QSize &actualSize,
+                   const FrameState &state) {
+  // 始终按设计尺寸布局，字体和圆角随窗口一起缩放
+  const QSize size = FrameRenderer::floatingBaseSize();
+  painter.scale(qreal(actualSize.width()) / size.width(),
+                qreal(actualSize.height()) / size.height());
+  const QRect rect(QPoint(0, 0), size);
+  const bool dark = state.isDarkTheme;
+
+  // 绘制半透明背景（深色主题为黑色，浅色主题为白色）
+  painter.setBrush(dark ? QColor(0, 0, 0, 200) : QColor(255, 255, 255, 220));
+  painter.setPen(Qt::NoPen);
+  painter.drawRoundedRect(rect, 15, 15);
+
+  // 设置超大字体
+  QFont font("Arial", 120, QFont::Bold);
+  painter.setFont(font);
+
+  // 根据阶段设置颜色
+  if (state.isWorkPhase) {
+    // 工作阶段红色
+    painter.setPen(dark ? QColor(255, 100, 100) : QColor(210, 40, 40));
+  } else {
+    // 休息阶段绿色
+    painter.setPen(dark ? QColor(100, 255, 100) : QColor(30, 150, 30));
+  }
+
+  // 绘制时间文本（显示分钟和秒数，格式：mm:ss）
+  const QString text = timeText(state.remainingSeconds);
+  painter.drawText(rect, Qt::AlignCenter, text);
+
+  // 绘制小文本显示阶段信息
+  QFont smallFont("Arial", 16, QFont::Normal);
+  painter.setFont(smallFont);
+  painter.setPen(dark ? Qt::white : Qt::black);
+
+  QString phaseText = state.isWorkPhase ? "工作阶段" : "休息阶段";
+  QRect phaseRect(10, 10, size.width() - 20, 30);
+  painter.drawText(phaseRect, Qt::AlignLeft | Qt::AlignTop, phaseText);
+
+  // 绘制时间格式提示
+  QRect formatRect(10, size.height() - 40, size.width() - 20, 30);
+  painter.drawText(formatRect, Qt::AlignLeft | Qt::AlignBottom, text);
+}
+
+} // namespace
+
+FrameRenderer::FrameRenderer(QObject *parent)
+    : QObject(parent), worker(new FrameRenderWorker(this)),
+      floatingSize(floatingBaseSize()), floatingDpr(1.0), fallbacks(0),
+      threaded(QFontDatabase::supportsThreadedFontRendering()) {
+  latestRemaining[TrayFrame].store(-1);
+  latestRemaining[FloatingFrame].store(-1);
+
+  // 平台不支持在其他线程中绘制文字时，渲染对象留在GUI线程，
+  // 预取的帧在事件循环空闲时依次渲染
+  if (!threaded) {
+    qInfo("FrameRenderer: 平台不支持多线程文字渲染，在GUI线程中预渲染");
+    return;
+  }
+  worker->moveToThread(&workerThread);
+  connect(&workerThread, &QThread::finished, worker, &QObject::deleteLater);
+  workerThread.setObjectName("FrameRenderer");
+  workerThread.start(QThread::LowPriority);
+}
+
+FrameRenderer::~FrameRenderer() {
+  if (!threaded) {
+    delete worker;
+    return;
+  }
+  workerThread.quit();
+  workerThread.wait();
+}
+
+quint64 FrameRenderer::frameKey(Kind kind, const FrameState &state) {
+  return (quint64(kind) << 60) | (quint64(state.isDarkTheme) << 59) |
+         (quint64(state.isWorkPhase) << 58) |
+         (quint64(quint32(state.totalSeconds)) << 24) |
+         quint64(quint32(state.remainingSeconds) & 0xffffff);
+}
+
+QImage FrameRenderer::render(Kind kind, const FrameState &state,
+                             const QSize &size, qreal devicePixelRatio) {
+  const QSize logicalSize = kind == TrayFrame ? TraySize : size;
+  const qreal dpr = kind == TrayFrame ? 1.0 : devicePixelRatio;
+
+  QImage image(logicalSize * dpr, QImage::Format_ARGB32_Premultiplied);
+  image.setDevicePixelRatio(dpr);
+  image.fill(Qt::transparent);
+
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::Antialiasing);
+  if (kind == TrayFrame) {
+    paintTray(painter, logicalSize, state);
+  } else {
+    paintFloating(painter, logicalSize, state);
+  }
+  return image;
+}
+
+QImage FrameRenderer::frame(Kind kind, const FrameState &state) {
+  latestRemaining[kind].store(state.remainingSeconds);
+  const quint64 key = frameKey(kind, state);
+
+  QSize size;
+  qreal dpr;
+  {
+    QMutexLocker locker(&mutex);
+    // 倒计时只会减少，剩余时间更长的帧已经用不到了
+    for (auto it = frames.begin(); it != frames.end();) {
+      if (int(it.key() >> 60) == kind &&
+          int(it.key() & 0xffffff) > state.remainingSeconds) {
+        it = frames.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    // 保留当前帧，同一秒内的多次重绘（例如窗口被遮挡后重新显示）可以复用
+    auto it = frames.constFind(key);
+    if (it != frames.cend()) {
+      return it.value();
+    }
+    size = floatingSize;
+    dpr = floatingDpr;
+  }
+
+  // 后台线程没有跟上，退回同步渲染
+  fallbacks++;
+  QImage image = render(kind, state, size, dpr);
+  Job job{kind, state, size, dpr, key};
+  store(job, image);
+  return image;
+}
+
+void FrameRenderer::prefetch(Kind kind, const FrameState &state, int seconds) {
+  QList<Job> jobs;
+  {
+    QMutexLocker locker(&mutex);
+    for (int i = 1; i <= seconds && state.remainingSeconds - i >= 0; ++i) {
+      FrameState next = state;
+      next.remainingSeconds -= i;
+      const quint64 key = frameKey(kind, next);
+      if (!frames.contains(key)) {
+        jobs.append({kind, next, floatingSize, floatingDpr, key});
+      }
+    }
+  }
+  if (jobs.isEmpty()) {
+    return;
+  }
+
+  FrameRenderWorker *target = worker;
+  QMetaObject::invokeMethod(
+      worker, [target, jobs]() { target->renderJobs(jobs); },
+      Qt::QueuedConnection);
+}
+
+void FrameRenderer::setFloatingGeometry(const QSize &size,
+                                        qreal devicePixelRatio) {
+  QMutexLocker locker(&mutex);
+  if (floatingSize == size && qFuzzyCompare(floatingDpr, devicePixelRatio)) {
+    return;
+  }
+  floatingSize = size;
+  floatingDpr = devicePixelRatio;
+
+  // 尺寸变化后已渲染的浮动窗口帧全部作废
+  for (auto it = frames.begin(); it != frames.end();) {
+    if ((it.key() >> 60) == FloatingFrame) {
+      it = frames.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+int FrameRenderer::cachedFrameCount() const {
+  QMutexLocker locker(&mutex);
+  return frames.size();
+}
+
+void FrameRenderer::store(const Job &job, const QImage &image) {
+  QMutexLocker locker(&mutex);
+  // 渲染期间浮动窗口尺寸发生了变化，这一帧作废
+  if (job.kind == FloatingFrame &&
+      (job.size != floatingSize ||
+       !qFuzzyCompare(job.devicePixelRatio, floatingDpr))) {
+    return;
+  }
+  if (frames.size() >= MaxCachedFrames) {
+    frames.clear(); // 异常情况（例如频繁重置）下防止缓存无限增长
+  }
+  frames.insert(job.key, image);
+}
+
+FrameRenderWorker::FrameRenderWorker(FrameRenderer *renderer)
+    : renderer(renderer) {}
+
+void FrameRenderWorker::renderJobs(const QList<FrameRenderer::Job> &jobs) {
+  for (const FrameRenderer::Job &job : jobs) {
+    // 跳过已经错过显示时间的帧
+    const int latest = renderer->latestRemaining[job.kind].load();
+    if (latest >= 0 && job.state.remainingSeconds >= latest) {
+      continue;
+    }
+    renderer->store(job, FrameRenderer::render(job.kind, job.state, job.size,
+                                               job.devicePixelRatio));
+  }
+}
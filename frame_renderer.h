@@ -0,0 +1,88 @@
+#ifndef FRAME_RENDERER_H
+#define FRAME_RENDERER_H
+
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSize>
+#include <QThread>
+#include <atomic>
+
+// 渲染一帧所需的全部状态，相同状态渲染出的图像完全相同
+struct FrameState {
+  int remainingSeconds = 0;
+  int totalSeconds = 1;
+  bool isWorkPhase = true;
+  bool isDarkTheme = false;
+};
+
+class FrameRenderWorker;
+
+// 托盘图标和浮动窗口的帧渲染：后台线程提前1-2秒把即将显示的帧画到QImage，
+// GUI线程只取出现成的帧；后台线程没跟上时退回同步渲染
+class FrameRenderer : public QObject {
+  Q_OBJECT
+
+public:
+  enum Kind { TrayFrame, FloatingFrame };
+
+  explicit FrameRenderer(QObject *parent = nullptr);
+  ~FrameRenderer();
+
+  // 取出指定状态的帧，尚未渲染好时在当前线程同步渲染
+  QImage frame(Kind kind, const FrameState &state);
+  // 请求后台渲染从state开始之后seconds秒的帧
+  void prefetch(Kind kind, const FrameState &state, int seconds = 2);
+
+  void setFloatingGeometry(const QSize &size, qreal devicePixelRatio);
+  // 浮动窗口的设计尺寸，实际尺寸按屏幕缩放，绘制时等比放大
+  static QSize floatingBaseSize() { return QSize(400, 200); }
+
+  int fallbackCount() const { return fallbacks; }
+  int cachedFrameCount() const;
+
+  // 实际的绘制代码，可在任意线程调用
+  static QImage render(Kind kind, const FrameState &state, const QSize &size,
+                       qreal devicePixelRatio);
+
+private:
+  friend class FrameRenderWorker;
+
+  struct Job {
+    Kind kind;
+    FrameState state;
+    QSize size;
+    qreal devicePixelRatio;
+    quint64 key;
+  };
+
+  static quint64 frameKey(Kind kind, const FrameState &state);
+  void store(const Job &job, const QImage &image);
+
+  QThread workerThread;
+  FrameRenderWorker *worker;
+  mutable QMutex mutex;
+  QHash<quint64, QImage> frames; // 已渲染好的帧
+  QSize floatingSize;
+  qreal floatingDpr;
+  int fallbacks;
+  bool threaded; // 是否在后台线程中渲染（取决于平台能否多线程绘制文字）
+  std::atomic<int> latestRemaining[2]; // GUI线程当前显示到的秒数
+};
+
+// 运行在后台线程中的渲染对象
+class FrameRenderWorker : public QObject {
+  Q_OBJECT
+
+public:
+  explicit FrameRenderWorker(FrameRenderer *renderer);
+
+  void renderJobs(const QList<FrameRenderer::Job> &jobs);
+
+private:
+  FrameRenderer *renderer;
+};
+
+#endif // FRAME_RENDERER_H
@@ -0,0 +1,337 @@
+#include "history_archive.h"
+#include "state_file.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace {
+
+const quint32 SegmentMagic = 0x50485347; // "PHSG"
+const quint32 SegmentVersion = 1;
+
+const QString SealingSuffix = ".sealing";
+
+bool entryBefore(const HistoryEntry &a, const HistoryEntry &b) {
+  return a.timestampMs < b.timestampMs;
+}
+
+// 封存段的代数：yyyy-MM.seg为0，yyyy-MM.N.seg为N
+int segmentGeneration(const QFileInfo &info) {
+  const QString name = info.completeBaseName();
+  const int dot = name.indexOf('.');
+  return dot < 0 ? 0 : name.mid(dot + 1).toInt();
+}
+
+} // namespace
+
+HistoryArchive::HistoryArchive(const QString &directory) : dir(directory) {
+  if (dir.isEmpty()) {
+    dir = StateFile::directory() + "/history";
+  }
+  QDir().mkpath(dir);
+  recover();
+}
+
+void HistoryArchive::recover() {
+  // 目标段已经写入时.sealing中的记录都在段里，否则恢复为热文件
+  const QStringList sealing = QDir(dir).entryList(
+      QStringList() << "*" + SealingSuffix, QDir::Files, QDir::Name);
+  for (const QString &fileName : sealing) {
+    const QString path = dir + "/" + fileName;
+    const QString target = path.chopped(SealingSuffix.size());
+    if (QFile::exists(target)) {
+      QFile::remove(path);
+    } else {
+      restoreHot(path, segmentMonth(target));
+    }
+  }
+
+  // 此时还没有快照引用旧段，可以安全删除
+  QList<QFileInfo> superseded;
+  latestSegments(&superseded);
+  for (const QFileInfo &info : superseded) {
+    QFile::remove(info.filePath());
+  }
+}
+
+bool HistoryArchive::restoreHot(const QString &sealingPath,
+                                const QString &month) {
+  const QString path = hotPath(month);
+  if (!QFile::exists(path)) {
+    return QFile::rename(sealingPath, path);
+  }
+  // 封存期间又有记录写入了这个月的热文件（例如系统时间被调回），逐条追加回去
+  bool ok = true;
+  for (const HistoryEntry &entry : readHotFile(sealingPath)) {
+    ok = append(entry) && ok;
+  }
+  return ok && QFile::remove(sealingPath);
+}
+
+QString HistoryArchive::monthOf(qint64 timestampMs) {
+  return QDateTime::fromMSecsSinceEpoch(timestampMs).toString("yyyy-MM");
+}
+
+QString HistoryArchive::hotPath(const QString &month) const {
+  return dir + "/" + month + ".hot";
+}
+
+QString HistoryArchive::segmentMonth(const QString &path) {
+  return QFileInfo(path).baseName();
+}
+
+QString HistoryArchive::segmentPath(const QString &month,
+                                    int generation) const {
+  if (generation == 0) {
+    return dir + "/" + month + ".seg";
+  }
+  return dir + "/" + month + "." + QString::number(generation) + ".seg";
+}
+
+QList<QFileInfo>
+HistoryArchive::latestSegments(QList<QFileInfo> *superseded) const {
+  // 目录列表已经带有文件大小，不需要逐个打开文件
+  const QFileInfoList files = QDir(dir).entryInfoList(
+      QStringList() << "*.seg", QDir::Files, QDir::Name);
+  QMap<QString, QFileInfo> latest; // 按月份排序
+  for (const QFileInfo &info : files) {
+    const QString month = segmentMonth(info.fileName());
+    auto it = latest.find(month);
+    if (it == latest.end()) {
+      latest.insert(month, info);
+      continue;
+    }
+    const bool newer = segmentGeneration(info) > segmentGeneration(*it);
+    if (superseded) {
+      superseded->append(newer ? *it : info);
+    }
+    if (newer) {
+      *it = info;
+    }
+  }
+  return latest.values();
+}
+
+bool HistoryArchive::append(const HistoryEntry &entry) {
+  QFile file(hotPath(monthOf(entry.timestampMs)));
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    qWarning("HistoryArchive: 无法写入 %s", qPrintable(file.fileName()));
+    return false;
+  }
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_6_0);
+  out << entry.timestampMs << entry.theme;
+  return out.status() == QDataStream::Ok;
+}
+
+QList<HistoryEntry> HistoryArchive::readHotFile(const QString &path) {
+  QList<HistoryEntry> entries;
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return entries;
+  }
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_6_0);
+  while (!in.atEnd()) {
+    HistoryEntry entry;
+    in >> entry.timestampMs >> entry.theme;
+    if (in.status() != QDataStream::Ok) {
+      break; // 末尾不完整的记录（例如写入时崩溃）直接丢弃
+    }
+    entries.append(entry);
+  }
+  return entries;
+}
+
+QList<HistoryEntry> HistoryArchive::readHotEntries() const {
+  QList<HistoryEntry> entries;
+  const QStringList files =
+      QDir(dir).entryList(QStringList() << "*.hot", QDir::Files, QDir::Name);
+  for (const QString &fileName : files) {
+    entries.append(readHotFile(dir + "/" + fileName));
+  }
+  std::stable_sort(entries.begin(), entries.end(), entryBefore);
+  return entries;
+}
+
+bool HistoryArchive::readSegmentHeader(const QString &path,
+                                       ArchiveSegment *segment) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_6_0);
+  quint32 magic, version;
+  qint32 count;
+  in >> magic >> version >> count >> segment->minTs >> segment->maxTs;
+  if (in.status() != QDataStream::Ok || magic != SegmentMagic ||
+      version != SegmentVersion) {
+    return false;
+  }
+  segment->path = path;
+  segment->count = count;
+  segment->bytes = file.size();
+  return true;
+}
+
+QList<ArchiveSegment> HistoryArchive::sealedSegments(
+    const QList<ArchiveSegment> &index, int *headersRead) const {
+  QHash<QString, ArchiveSegment> cached;
+  for (const ArchiveSegment &segment : index) {
+    cached.insert(QFileInfo(segment.path).fileName(), segment);
+  }
+
+  QList<ArchiveSegment> segments;
+  // 同一个月只使用最新一代的段，旧段可能仍被快照引用
+  for (const QFileInfo &info : latestSegments()) {
+    auto hit = cached.constFind(info.fileName());
+    if (hit != cached.constEnd() && hit->bytes == info.size()) {
+      ArchiveSegment segment = *hit;
+      segment.path = info.filePath();
+      segments.append(segment);
+      continue;
+    }
+    ArchiveSegment segment;
+    if (headersRead) {
+      ++*headersRead;
+    }
+    if (readSegmentHeader(info.filePath(), &segment)) {
+      segments.append(segment);
+    } else {
+      qWarning("HistoryArchive: 跳过损坏的封存段 %s",
+               qPrintable(info.fileName()));
+    }
+  }
+  return segments;
+}
+
+QList<HistoryEntry> HistoryArchive::readSegment(const ArchiveSegment &segment) {
+  QList<HistoryEntry> entries;
+  QFile file(segment.path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return entries;
+  }
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_6_0);
+  quint32 magic, version;
+  qint32 count;
+  qint64 minTs, maxTs;
+  QByteArray compressed;
+  in >> magic >> version >> count >> minTs >> maxTs >> compressed;
+  if (in.status() != QDataStream::Ok) {
+    return entries;
+  }
+
+  const QByteArray payload = qUncompress(compressed);
+  QDataStream data(payload);
+  data.setVersion(QDataStream::Qt_6_0);
+  entries.reserve(count);
+  for (qint32 i = 0; i < count; ++i) {
+    HistoryEntry entry;
+    data >> entry.timestampMs >> entry.theme;
+    if (data.status() != QDataStream::Ok) {
+      break;
+    }
+    entries.append(entry);
+  }
+  return entries;
+}
+
+QStringList HistoryArchive::hotMonthsBefore(const QDate &month) const {
+  const QString limit = month.toString("yyyy-MM");
+  QStringList months;
+  const QStringList files =
+      QDir(dir).entryList(QStringList() << "*.hot", QDir::Files, QDir::Name);
+  for (const QString &fileName : files) {
+    const QString name = QFileInfo(fileName).completeBaseName();
+    if (name < limit) {
+      months.append(name);
+    }
+  }
+  return months;
+}
+
+bool HistoryArchive::sealMonth(const QString &month, ArchiveSegment *segment) {
+  // 同一个月已有封存段时（例如系统时间被调回过）合并后写入新一代的段，
+  // 旧段保持不变，已有的快照仍然可以读取
+  int generation = 0;
+  ArchiveSegment existing;
+  bool hasExisting = false;
+  for (const QFileInfo &info : latestSegments()) {
+    if (segmentMonth(info.fileName()) == month) {
+      generation = segmentGeneration(info) + 1;
+      hasExisting = readSegmentHeader(info.filePath(), &existing);
+      break;
+    }
+  }
+  const QString target = segmentPath(month, generation);
+
+  // 先把热文件改名：之后写入的记录进入新的热文件，
+  // 崩溃后根据目标段是否存在决定丢弃还是恢复.sealing
+  const QString sealingPath = target + SealingSuffix;
+  if (!QFile::rename(hotPath(month), sealingPath)) {
+    return false;
+  }
+  QList<HistoryEntry> entries = readHotFile(sealingPath);
+  if (hasExisting) {
+    entries.append(readSegment(existing));
+  }
+  std::stable_sort(entries.begin(), entries.end(), entryBefore);
+
+  QByteArray payload;
+  QDataStream data(&payload, QIODevice::WriteOnly);
+  data.setVersion(QDataStream::Qt_6_0);
+  for (const HistoryEntry &entry : entries) {
+    data << entry.timestampMs << entry.theme;
+  }
+
+  segment->path = target;
+  segment->count = entries.size();
+  segment->minTs = entries.isEmpty() ? 0 : entries.first().timestampMs;
+  segment->maxTs = entries.isEmpty() ? 0 : entries.last().timestampMs;
+
+  QSaveFile file(segment->path);
+  bool ok = file.open(QIODevice::WriteOnly);
+  if (ok) {
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << SegmentMagic << SegmentVersion << qint32(segment->count)
+        << segment->minTs << segment->maxTs << qCompress(payload, 9);
+    ok = file.commit();
+  }
+  if (!ok) {
+    restoreHot(sealingPath, month);
+    return false;
+  }
+  segment->bytes = QFileInfo(segment->path).size();
+
+  // 封存段写入成功后才删除原来的热文件
+  QFile::remove(sealingPath);
+  return true;
+}
+
+bool HistoryArchive::isEmpty() const {
+  return QDir(dir)
+      .entryList(QStringList() << "*.hot" << "*.seg", QDir::Files)
+      .isEmpty();
+}
+
+qint64 HistoryArchive::diskUsage() const {
+  qint64 total = 0;
+  const QFileInfoList files = QDir(dir).entryInfoList(
+      QStringList() << "*.hot" << "*.seg", QDir::Files);
+  for (const QFileInfo &info : files) {
+    total += info.size();
+  }
+  return total;
+}
@@ -0,0 +1,73 @@
+#ifndef HISTORY_ARCHIVE_H
+#define HISTORY_ARCHIVE_H
+
+#include <QDate>
+#include <QFileInfo>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// 一条主题记录
+struct HistoryEntry {
+  qint64 timestampMs = 0; // 记录时间（自纪元起的毫秒数）
+  QString theme;
+};
+
+// 已封存的压缩段（一个月的记录），头部记录条数和时间范围
+struct ArchiveSegment {
+  QString path;
+  int count = 0;
+  qint64 minTs = 0;
+  qint64 maxTs = 0;
+  qint64 bytes = 0; // 文件大小，用于判断索引中的头部是否过期
+};
+
+// 按月分区的历史存档：当月记录追加到未压缩的热文件（yyyy-MM.hot），
+// 之前的月份压缩为封存段（yyyy-MM.seg），查询时只需读取头部就能跳过无关的段。
+// 重新封存同一个月时写入新一代的段（yyyy-MM.N.seg），旧段可能仍被快照引用，
+// 下次打开存档时才删除
+class HistoryArchive {
+public:
+  // directory为空时使用应用数据目录下的history目录。
+  // 打开时恢复中断的封存并删除已被取代的旧段
+  explicit HistoryArchive(const QString &directory = QString());
+
+  bool append(const HistoryEntry &entry);
+
+  // 所有热文件中的记录，按时间排序
+  QList<HistoryEntry> readHotEntries() const;
+  // 读取所有封存段的头部（不解压）。文件名和大小与索引一致的段
+  // 直接使用索引中的头部，不再打开文件；headersRead返回实际读取的头部数
+  QList<ArchiveSegment> sealedSegments(
+      const QList<ArchiveSegment> &index = QList<ArchiveSegment>(),
+      int *headersRead = nullptr) const;
+  // 解压读取一个封存段，可在任意线程调用
+  static QList<HistoryEntry> readSegment(const ArchiveSegment &segment);
+
+  // 早于指定月份、尚未封存的月份（格式yyyy-MM）
+  QStringList hotMonthsBefore(const QDate &month) const;
+  // 把一个月的热文件压缩为封存段，成功后删除热文件。热文件先改名为
+  // <目标段>.sealing，中途崩溃时打开存档能判断它是否已写入段中
+  bool sealMonth(const QString &month, ArchiveSegment *segment);
+
+  bool isEmpty() const;
+  qint64 diskUsage() const;
+
+  static QString monthOf(qint64 timestampMs);
+  // 封存段所属的月份（yyyy-MM）
+  static QString segmentMonth(const QString &path);
+
+private:
+  QString hotPath(const QString &month) const;
+  QString segmentPath(const QString &month, int generation) const;
+  // 每个月最新一代的封存段，superseded返回被取代的旧段
+  QList<QFileInfo> latestSegments(QList<QFileInfo> *superseded = nullptr) const;
+  void recover();
+  bool restoreHot(const QString &sealingPath, const QString &month);
+  static QList<HistoryEntry> readHotFile(const QString &path);
+  static bool readSegmentHeader(const QString &path, ArchiveSegment *segment);
+
+  QString dir;
+};
+
+#endif // HISTORY_ARCHIVE_H
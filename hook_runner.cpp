@@ -0,0 +1,196 @@
+#include "hook_runner.h"
+#include "state_file.h"
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QProcessEnvironment>
+#include <QSettings>
+
+HookRunner::HookRunner(QObject *parent)
+    : QObject(parent), config(loadConfig()), worker(new HookWorker(config)) {
+  worker->moveToThread(&workerThread);
+  connect(&workerThread, &QThread::finished, worker, &QObject::deleteLater);
+  workerThread.setObjectName("HookRunner");
+  workerThread.start(QThread::LowPriority);
+}
+
+HookRunner::~HookRunner() {
+  workerThread.quit();
+  workerThread.wait();
+}
+
+QString HookRunner::eventName(Event event) {
+  static const char *names[] = {"start", "pause", "phaseSwitch", "themeSaved"};
+  return names[event];
+}
+
+HookRunner::Config HookRunner::loadConfig() {
+  Config config;
+  if (StateFile::isIsolated()) {
+    return config; // 独立的数据目录中不运行用户配置的钩子
+  }
+  QSettings settings("PomodoroApp", "QtPomodoro");
+  settings.beginGroup("Hooks");
+  for (int i = 0; i < EventCount; ++i) {
+    config.commands[i] = settings.value(eventName(Event(i))).toStringList();
+    config.commands[i].removeAll(QString());
+  }
+  config.maxConcurrent =
+      qMax(1, settings.value("maxConcurrent", config.maxConcurrent).toInt());
+  config.maxQueued =
+      qMax(1, settings.value("maxQueued", config.maxQueued).toInt());
+  config.timeoutMs = settings.value("timeoutMs", config.timeoutMs).toInt();
+  settings.endGroup();
+  return config;
+}
+
+void HookRunner::trigger(Event event, const QJsonObject &data) {
+  if (!hasHooks(event)) {
+    return;
+  }
+
+  QJsonObject payload = data;
+  payload["event"] = eventName(event);
+  payload["time"] = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+
+  HookWorker *target = worker;
+  QMetaObject::invokeMethod(
+      worker, [target, event, payload]() { target->enqueue(event, payload); },
+      Qt::QueuedConnection);
+}
+
+HookWorker::HookWorker(const HookRunner::Config &config)
+    : config(config), running(0), dropped(0) {}
+
+HookWorker::~HookWorker() {
+  for (Runner *runner : runners) {
+    // 先断开连接，结束进程时不再回调到正在析构的对象
+    disconnect(runner->process, nullptr, this, nullptr);
+    delete runner->process;
+    delete runner;
+  }
+}
+
+void HookWorker::enqueue(HookRunner::Event event, const QJsonObject &payload) {
+  for (const QString &command : config.commands[event]) {
+    // 同一钩子还在排队时只保留最新的事件
+    bool merged = false;
+    for (Job &job : queue) {
+      if (job.event == event && job.command == command) {
+        job.payload = payload;
+        job.coalesced++;
+        merged = true;
+        break;
+      }
+    }
+    if (merged) {
+      continue;
+    }
+
+    // 队列满时丢弃最早的任务，不阻塞也不无限堆积
+    if (queue.size() >= config.maxQueued) {
+      const Job oldest = queue.takeFirst();
+      dropped++;
+      qWarning("HookRunner: 队列已满，丢弃 %s 钩子 (累计丢弃 %d)",
+               qPrintable(HookRunner::eventName(oldest.event)), dropped);
+    }
+    queue.append({event, command, payload, 0});
+  }
+  dispatch();
+}
+
+void HookWorker::dispatch() {
+  while (running < config.maxConcurrent && !queue.isEmpty()) {
+    launch(idleRunner(), queue.takeFirst());
+  }
+}
+
+HookWorker::Runner *HookWorker::idleRunner() {
+  for (Runner *runner : runners) {
+    if (!runner->busy) {
+      return runner;
+    }
+  }
+
+  Runner *runner = new Runner;
+  runner->process = new QProcess(this);
+  runner->process->setStandardOutputFile(QProcess::nullDevice());
+  runner->process->setStandardErrorFile(QProcess::nullDevice());
+  runner->timeout = new QTimer(this);
+  runner->timeout->setSingleShot(true);
+
+  connect(runner->process, &QProcess::finished, this,
+          [this, runner]() { onFinished(runner); });
+  connect(runner->process, &QProcess::errorOccurred, this,
+          [this, runner](QProcess::ProcessError error) {
+            // 启动失败时不会发出finished
+            if (error == QProcess::FailedToStart) {
+              onFinished(runner);
+            }
+          });
+  connect(runner->timeout, &QTimer::timeout, this, [runner]() {
+    runner->timedOut = true;
+    runner->process->kill();
+  });
+  runners.append(runner);
+  return runner;
+}
+
+void HookWorker::launch(Runner *runner, const Job &job) {
+  QStringList arguments = QProcess::splitCommand(job.command);
+  if (arguments.isEmpty()) {
+    return;
+  }
+  const QString program = arguments.takeFirst();
+
+  QJsonObject payload = job.payload;
+  payload["coalesced"] = job.coalesced;
+
+  QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+  environment.insert("POMODORO_EVENT", HookRunner::eventName(job.event));
+
+  runner->job = job;
+  runner->busy = true;
+  runner->timedOut = false;
+  runner->elapsed.start();
+  running++;
+
+  runner->process->setProcessEnvironment(environment);
+  runner->process->start(program, arguments);
+  if (!runner->busy) {
+    return; // 同步启动失败，已经在onFinished中处理
+  }
+  // 进程启动前写入的数据会先缓存，启动后再送达
+  runner->process->write(
+      QJsonDocument(payload).toJson(QJsonDocument::Compact));
+  runner->process->closeWriteChannel();
+  if (config.timeoutMs > 0) {
+    runner->timeout->start(config.timeoutMs);
+  }
+}
+
+void HookWorker::onFinished(Runner *runner) {
+  if (!runner->busy) {
+    return;
+  }
+  runner->timeout->stop();
+  runner->busy = false;
+  running--;
+
+  const QString name = HookRunner::eventName(runner->job.event);
+  if (runner->timedOut) {
+    qWarning("HookRunner: %s 钩子超时 (%lld ms)，已结束: %s", qPrintable(name),
+             runner->elapsed.elapsed(), qPrintable(runner->job.command));
+  } else if (runner->process->error() == QProcess::FailedToStart) {
+    qWarning("HookRunner: 无法启动 %s 钩子: %s", qPrintable(name),
+             qPrintable(runner->job.command));
+  } else if (runner->process->exitStatus() != QProcess::NormalExit ||
+             runner->process->exitCode() != 0) {
+    qWarning("HookRunner: %s 钩子退出码 %d: %s", qPrintable(name),
+             runner->process->exitCode(), qPrintable(runner->job.command));
+  }
+
+  // 启动失败时这里可能位于launch()中的start()调用之内，
+  // 排队到事件循环再派发，避免在同一个runner上重入launch()
+  QMetaObject::invokeMethod(this, [this]() { dispatch(); },
+                            Qt::QueuedConnection);
+}
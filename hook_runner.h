@@ -0,0 +1,94 @@
+#ifndef HOOK_RUNNER_H
+#define HOOK_RUNNER_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+
+class HookWorker;
+
+// 事件钩子：在设置的Hooks分组中为事件配置外部命令，事件发生时
+// 以JSON通过标准输入传给命令。命令在后台线程的有限进程池中执行，
+// 排队、超时和合并都在后台完成，慢钩子不会拖慢计时器或界面
+class HookRunner : public QObject {
+  Q_OBJECT
+
+public:
+  enum Event { Start, Pause, PhaseSwitch, ThemeSaved, EventCount };
+
+  // 钩子配置，对应设置中的Hooks分组
+  struct Config {
+    QStringList commands[EventCount]; // 每个事件可以配置多条命令
+    int maxConcurrent = 2;            // 同时运行的进程数
+    int maxQueued = 32;               // 排队上限，超出时丢弃最早的任务
+    int timeoutMs = 10000;            // 超时后结束进程
+  };
+
+  explicit HookRunner(QObject *parent = nullptr);
+  ~HookRunner();
+
+  // 触发事件，立即返回
+  void trigger(Event event, const QJsonObject &data);
+  bool hasHooks(Event event) const {
+    return !config.commands[event].isEmpty();
+  }
+
+  static QString eventName(Event event);
+
+private:
+  static Config loadConfig();
+
+  Config config;
+  QThread workerThread;
+  HookWorker *worker;
+};
+
+// 运行在后台线程中的进程池
+class HookWorker : public QObject {
+  Q_OBJECT
+
+public:
+  explicit HookWorker(const HookRunner::Config &config);
+  ~HookWorker();
+
+  void enqueue(HookRunner::Event event, const QJsonObject &payload);
+
+  int queuedCount() const { return queue.size(); }
+  int runningCount() const { return running; }
+  int droppedCount() const { return dropped; }
+
+private:
+  struct Job {
+    HookRunner::Event event;
+    QString command;
+    QJsonObject payload;
+    int coalesced = 0; // 被合并掉的事件数
+  };
+
+  struct Runner {
+    QProcess *process = nullptr;
+    QTimer *timeout = nullptr;
+    Job job;
+    QElapsedTimer elapsed;
+    bool busy = false;
+    bool timedOut = false;
+  };
+
+  void dispatch();
+  void launch(Runner *runner, const Job &job);
+  void onFinished(Runner *runner);
+  Runner *idleRunner();
+
+  HookRunner::Config config;
+  QList<Job> queue;
+  QList<Runner *> runners; // 进程对象复用，数量不超过maxConcurrent
+  int running;
+  int dropped;
+};
+
+#endif // HOOK_RUNNER_H
@@ -0,0 +1,282 @@
+#include "idle_monitor.h"
+#include <QElapsedTimer>
+#include <QGuiApplication>
+
+#ifdef POMODORO_HAVE_DBUS
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#endif
+
+#if defined(Q_OS_MACOS)
+#include <CoreFoundation/CoreFoundation.h>
+#include <IOKit/IOKitLib.h>
+#endif
+
+// Xlib定义了大量宏（Bool、Status、None等），放在所有Qt头文件之后
+#ifdef POMODORO_HAVE_XSS
+#include <X11/Xlib.h>
+#include <X11/extensions/scrnsaver.h>
+#endif
+
+namespace {
+
+const int MinPollMs = 1000;      // 两次检查的最短间隔
+const int MaxPollMs = 60 * 1000; // 用户活跃时最长的检查间隔
+const int ReturnPollMs = 1000;   // 离开期间检查用户是否回来
+
+#ifdef POMODORO_HAVE_XSS
+// X11屏幕保护扩展：服务器直接记录最后一次输入的时间，查询是一次往返
+class X11IdleSource : public IdleSource {
+public:
+  X11IdleSource() : display(XOpenDisplay(nullptr)), info(nullptr) {
+    int eventBase, errorBase;
+    if (display &&
+        XScreenSaverQueryExtension(display, &eventBase, &errorBase)) {
+      info = XScreenSaverAllocInfo();
+    }
+  }
+  ~X11IdleSource() override {
+    if (info) {
+      XFree(info);
+    }
+    if (display) {
+      XCloseDisplay(display);
+    }
+  }
+
+  bool isValid() const { return info != nullptr; }
+  QString name() const override { return "x11-screensaver"; }
+  qint64 idleMs() override {
+    if (!XScreenSaverQueryInfo(display, DefaultRootWindow(display), info)) {
+      return -1;
+    }
+    return qint64(info->idle);
+  }
+
+private:
+  Display *display;
+  XScreenSaverInfo *info;
+};
+#endif
+
+#if defined(Q_OS_MACOS)
+// IOKit：IOHIDSystem的HIDIdleTime属性（纳秒）
+class IOKitIdleSource : public IdleSource {
+public:
+  IOKitIdleSource() : service(0) {
+    io_iterator_t iterator;
+    // 0即默认的主端口，兼容新旧SDK中不同的常量名
+    if (IOServiceGetMatchingServices(0, IOServiceMatching("IOHIDSystem"),
+                                     &iterator) == KERN_SUCCESS) {
+      service = IOIteratorNext(iterator);
+      IOObjectRelease(iterator);
+    }
+  }
+  ~IOKitIdleSource() override {
+    if (service) {
+      IOObjectRelease(service);
+    }
+  }
+
+  bool isValid() const { return service != 0; }
+  QString name() const override { return "iokit-hid"; }
+  qint64 idleMs() override {
+    CFTypeRef property = IORegistryEntryCreateCFProperty(
+        service, CFSTR("HIDIdleTime"), kCFAllocatorDefault, 0);
+    if (!property) {
+      return -1;
+    }
+    qint64 nanoseconds = -1;
+    if (CFGetTypeID(property) == CFNumberGetTypeID()) {
+      CFNumberGetValue(static_cast<CFNumberRef>(property),
+                       kCFNumberSInt64Type, &nanoseconds);
+    }
+    CFRelease(property);
+    return nanoseconds < 0 ? -1 : nanoseconds / 1000000;
+  }
+
+private:
+  io_service_t service;
+};
+#endif
+
+#ifdef POMODORO_HAVE_DBUS
+// logind会话的空闲提示（Wayland下的后备方案）。
+// 提示由桌面环境在它自己的空闲延迟之后设置，精度取决于桌面环境。
+// 系统总线的调用可能很慢，查询全部异步发出：每次返回上一次应答的结果，
+// 状态变化最多晚一个检查间隔才被发现
+class LogindIdleSource : public IdleSource {
+public:
+  LogindIdleSource()
+      : bus(QDBusConnection::systemBus()), pending(false), failed(false),
+        idleHint(false), idleSinceUs(0) {
+    request();
+  }
+
+  bool isValid() const { return bus.isConnected(); }
+  QString name() const override { return "logind"; }
+  qint64 idleMs() override {
+    request();
+    if (failed) {
+      return -1;
+    }
+    if (!idleHint) {
+      return 0;
+    }
+    // IdleSinceHint为自纪元起的微秒数
+    const qint64 sinceMs = qint64(idleSinceUs / 1000);
+    return qMax<qint64>(0, QDateTime::currentMSecsSinceEpoch() - sinceMs);
+  }
+
+private:
+  void request() {
+    if (pending || !bus.isConnected()) {
+      return;
+    }
+    QDBusMessage message = QDBusMessage::createMethodCall(
+        "org.freedesktop.login1", "/org/freedesktop/login1/session/auto",
+        "org.freedesktop.DBus.Properties", "GetAll");
+    message << QString("org.freedesktop.login1.Session");
+    pending = true;
+    auto *watcher =
+        new QDBusPendingCallWatcher(bus.asyncCall(message), &context);
+    QObject::connect(watcher, &QDBusPendingCallWatcher::finished, &context,
+                     [this](QDBusPendingCallWatcher *call) {
+                       const QDBusPendingReply<QVariantMap> reply = *call;
+                       call->deleteLater();
+                       pending = false;
+                       failed = reply.isError();
+                       if (!failed) {
+                         const QVariantMap properties = reply.value();
+                         idleHint = properties.value("IdleHint").toBool();
+                         idleSinceUs =
+                             properties.value("IdleSinceHint").toULongLong();
+                       }
+                     });
+  }
+
+  QDBusConnection bus;
+  QObject context; // 应答回调的接收者，随来源一起销毁时断开未完成的调用
+  bool pending;
+  bool failed;
+  bool idleHint;
+  quint64 idleSinceUs;
+};
+#endif
+
+} // namespace
+
+IdleMonitor::IdleMonitor(QObject *parent)
+    : QObject(parent), source(createDefaultSource()),
+      pollTimer(new QTimer(this)), thresholdMs(0), active(false), idle(false),
+      polls(0), pollNs(0) {
+  pollTimer->setSingleShot(true);
+  // 检查时间不需要精确，允许系统合并定时器唤醒
+  pollTimer->setTimerType(Qt::VeryCoarseTimer);
+  connect(pollTimer, &QTimer::timeout, this, &IdleMonitor::poll);
+}
+
+IdleMonitor::~IdleMonitor() = default;
+
+std::unique_ptr<IdleSource> IdleMonitor::createDefaultSource() {
+#if defined(Q_OS_MACOS)
+  auto iokit = std::make_unique<IOKitIdleSource>();
+  if (iokit->isValid()) {
+    return iokit;
+  }
+#endif
+#ifdef POMODORO_HAVE_XSS
+  // Wayland下XWayland只能看到X客户端的输入，不可靠
+  if (QGuiApplication::platformName() == "xcb") {
+    auto x11 = std::make_unique<X11IdleSource>();
+    if (x11->isValid()) {
+      return x11;
+    }
+  }
+#endif
+#ifdef POMODORO_HAVE_DBUS
+  auto logind = std::make_unique<LogindIdleSource>();
+  if (logind->isValid()) {
+    return logind;
+  }
+#endif
+  return nullptr;
+}
+
+void IdleMonitor::setSource(std::unique_ptr<IdleSource> newSource) {
+  source = std::move(newSource);
+  idle = false;
+  reschedule();
+}
+
+void IdleMonitor::setThreshold(int seconds) {
+  thresholdMs = qMax(0, seconds) * 1000;
+  reschedule();
+}
+
+void IdleMonitor::setActive(bool enable) {
+  if (active == enable) {
+    return;
+  }
+  active = enable;
+  idle = false;
+  reschedule();
+}
+
+QString IdleMonitor::sourceName() const {
+  return source ? source->name() : QString();
+}
+
+qint64 IdleMonitor::averagePollUs() const {
+  return polls > 0 ? pollNs / polls / 1000 : 0;
+}
+
+void IdleMonitor::reschedule() {
+  if (!active || !source || thresholdMs <= 0) {
+    pollTimer->stop();
+    return;
+  }
+  pollTimer->start(MinPollMs);
+}
+
+void IdleMonitor::poll() {
+  QElapsedTimer elapsed;
+  elapsed.start();
+  const qint64 idleMs = source->idleMs();
+  pollNs += elapsed.nsecsElapsed();
+  polls++;
+
+  if (idleMs < 0) {
+    pollTimer->start(MaxPollMs);
+    return;
+  }
+
+  const QDateTime now = QDateTime::currentDateTime();
+  if (idle) {
+    // 有了新的输入，空闲时间重新从零开始计算
+    if (idleMs < thresholdMs) {
+      idle = false;
+      emit idleEnded(idleSince, now.addMSecs(-idleMs));
+      if (!active) {
+        return; // 接收者在信号中停止了检测
+      }
+    } else {
+      pollTimer->start(ReturnPollMs);
+      return;
+    }
+  } else if (idleMs >= thresholdMs) {
+    idle = true;
+    idleSince = now.addMSecs(-idleMs);
+    emit idleStarted(idleSince);
+    if (active) {
+      pollTimer->start(ReturnPollMs);
+    }
+    return;
+  }
+
+  // 在此之前空闲时间不可能达到阈值
+  pollTimer->start(
+      int(qBound<qint64>(MinPollMs, thresholdMs - idleMs, MaxPollMs)));
+}
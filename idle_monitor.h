@@ -0,0 +1,69 @@
+#ifndef IDLE_MONITOR_H
+#define IDLE_MONITOR_H
+
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <memory>
+
+// 空闲时间来源：返回用户最近一次输入到现在的毫秒数，无法获取时返回-1
+class IdleSource {
+public:
+  virtual ~IdleSource() = default;
+  virtual QString name() const = 0;
+  virtual qint64 idleMs() = 0;
+};
+
+// 测试用的空闲来源，空闲时间由调用者设置
+class FakeIdleSource : public IdleSource {
+public:
+  QString name() const override { return "fake"; }
+  qint64 idleMs() override { return idle; }
+  void setIdleMs(qint64 ms) { idle = ms; }
+
+private:
+  qint64 idle = 0;
+};
+
+// 离开检测：按需轮询空闲来源，空闲超过阈值时发出idleStarted，
+// 用户回来后发出idleEnded。用户活跃时下一次检查安排在最早可能
+// 达到阈值的时刻，平时大约每分钟只查询一次
+class IdleMonitor : public QObject {
+  Q_OBJECT
+
+public:
+  explicit IdleMonitor(QObject *parent = nullptr);
+  ~IdleMonitor();
+
+  // 按平台依次尝试：X11屏幕保护扩展、macOS IOKit、logind空闲提示
+  static std::unique_ptr<IdleSource> createDefaultSource();
+
+  void setSource(std::unique_ptr<IdleSource> source);
+  void setThreshold(int seconds); // 0表示关闭
+  void setActive(bool active);    // 只在需要时轮询
+
+  bool isAvailable() const { return source != nullptr; }
+  QString sourceName() const;
+  qint64 pollCount() const { return polls; }
+  qint64 averagePollUs() const;
+
+signals:
+  void idleStarted(const QDateTime &since);
+  void idleEnded(const QDateTime &since, const QDateTime &until);
+
+private:
+  void poll();
+  void reschedule();
+
+  std::unique_ptr<IdleSource> source;
+  QTimer *pollTimer;
+  int thresholdMs;
+  bool active;
+  bool idle;
+  QDateTime idleSince;
+  qint64 polls;
+  qint64 pollNs; // 轮询累计耗时
+};
+
+#endif // IDLE_MONITOR_H
@@ -1,10 +1,104 @@
+#include "command_line.h"
 #include "mainwindow.h"
+#include "report_generator.h"
+#include "single_instance.h"
+#include "soak_runner.h"
+#include "state_file.h"
+#include "statistics_engine.h"
 #include <QApplication>
+#include <QStandardPaths>
+#include <QTemporaryDir>
 
 int main(int argc, char *argv[])
 {
+    QCoreApplication::setOrganizationName("PomodoroApp");
+    QCoreApplication::setApplicationName("QtPomodoro");
+
+    QStringList arguments;
+    for (int i = 0; i < argc; ++i) {
+        arguments << QString::fromLocal8Bit(argv[i]);
+    }
+
+    AppCommandLine commandLine;
+    commandLine.parse(arguments);
+
+    // 无界面命令：不创建任何窗口
+    if (commandLine.reportRequested()) {
+        QCoreApplication app(argc, argv);
+        ReportGenerator::Period period;
+        ReportGenerator::Format format;
+        if (!ReportGenerator::parsePeriod(commandLine.reportPeriod(), &period) ||
+            !ReportGenerator::parseFormat(commandLine.reportFormat(), &format)) {
+            qWarning("用法: --report weekly|monthly [--format md|html] "
+                     "[--output dir] [--data-dir dir]...");
+            return 2;
+        }
+        return ReportGenerator::generateBatch(period, format,
+                                              commandLine.dataDirs(),
+                                              commandLine.outputDir())
+                   ? 0
+                   : 1;
+    }
+
+    // 浸泡测试：设置、状态和历史都放在临时目录中，不读取也不修改用户的
+    // 系统设置（macOS的偏好设置、Windows的注册表），也不与正在运行的实例冲突
+    if (commandLine.soakRequested()) {
+        if (commandLine.soakDays() <= 0) {
+            qWarning("--soak 需要一个正整数天数");
+            return 2;
+        }
+        QStandardPaths::setTestModeEnabled(true);
+        QTemporaryDir store;
+        if (!store.isValid()) {
+            qWarning("浸泡测试: 无法创建临时目录");
+            return 1;
+        }
+        StateFile::setDirectory(store.path());
+        QApplication a(argc, argv);
+        MainWindow w;
+        w.show();
+        SoakRunner runner(&w, commandLine.soakDays(),
+                          commandLine.soakReportPath());
+        QObject::connect(&runner, &SoakRunner::finished, &a,
+                         &QCoreApplication::exit);
+        runner.start();
+        return a.exec();
+    }
+
+    // 已有实例在运行：只创建轻量的QCoreApplication，转发参数后立即退出
+    SingleInstance instance;
+    if (!instance.tryAcquire()) {
+        QCoreApplication app(argc, argv);
+        if (commandLine.rebuildStatsRequested()) {
+            // 运行中的实例随时会写入汇总文件，不能在它下面重建
+            qWarning("番茄时钟正在运行，请先退出再重建统计");
+            return 1;
+        }
+        if (!instance.forward(arguments)) {
+            qWarning("番茄时钟已在运行，但无法连接到该实例");
+            return 1;
+        }
+        return 0;
+    }
+
+    // 持有锁期间重建统计，不会与界面实例同时写入
+    if (commandLine.rebuildStatsRequested()) {
+        QCoreApplication app(argc, argv);
+        StatisticsEngine statistics(QString(), StatisticsEngine::NoRebuild);
+        return statistics.rebuild() ? 0 : 1;
+    }
+
+    // 拿到锁后立即监听：创建主窗口要加载历史和统计，
+    // 这期间转发来的参数先排队，窗口创建完成后再处理
     QApplication a(argc, argv);
+    instance.listen();
+    StateFile::migrateLegacyStores(); // 首次运行新版本时合并旧的设置文件
     MainWindow w;
+    QObject::connect(&instance, &SingleInstance::argumentsReceived, &w,
+                     &MainWindow::handleCommandLine);
+
     w.show();
+    w.handleCommandLine(arguments);
+    instance.setReceiverReady(); // 按启动顺序处理排队的参数
     return a.exec();
-}
\ No newline at end of file
+}
@@ -1,22 +1,36 @@
 #include "mainwindow.h"
+#include "command_line.h"
 #include "floating_timer.h"
 #include "reminder_dialog.h"
+#include "state_file.h"
+#include "statistics_window.h"
 #include "ui_mainwindow.h"
 #include <QCloseEvent>
+#include <QElapsedTimer>
 #include <QFont>
 #include <QInputDialog>
 #include <QMessageBox>
-#include <QPainter>
 #include <QPixmap>
-#include <QSoundEffect>
+#include <QtConcurrent>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow), timer(new QTimer(this)),
       isWorkPhase(true), completedCycles(0), isDarkTheme(false),
       volume(0.5f), // 默认音量50%
-      settings(new QSettings("PomodoroApp", "QtPomodoro", this)) {
+      settings(new QSettings(StateFile::path(), StateFile::format(), this)),
+      statisticsWindow(nullptr), autoPaused(false), tickInterval(1000),
+      phaseInterruptions(0), phaseRunningSeconds(0),
+      coldQueryUsBeforeCompaction(0), hotQueryUsBeforeCompaction(0) {
   ui->setupUi(this);
+  frameRenderer = new FrameRenderer(this);
   floatingTimer = new FloatingTimer(this);
+  floatingTimer->setFrameRenderer(frameRenderer);
+  toneSynth = new ToneSynth(this); // 启动时预先生成提示音
+  statistics = new StatisticsEngine(
+      QString(), StatisticsEngine::BackgroundRebuild, this);
+  themeManager = new ThemeManager(this);
+  hookRunner = new HookRunner(this);
+  idleMonitor = new IdleMonitor(this);
 
   // 从设置加载配置
   loadSettings();
@@ -50,6 +64,8 @@ MainWindow::MainWindow(QWidget *parent)
           &MainWindow::onSettingsButtonClicked);
   connect(ui->themeButton, &QPushButton::clicked, this,
           &MainWindow::onThemeChanged);
+  connect(ui->statsButton, &QPushButton::clicked, this,
+          &MainWindow::showStatistics);
   connect(ui->floatingButton, &QPushButton::clicked, this,
           &MainWindow::toggleFloatingWindow);
   connect(ui->resetPositionButton, &QPushButton::clicked, this,
@@ -84,15 +100,73 @@ MainWindow::MainWindow(QWidget *parent)
   // 更新托盘图标显示
   updateTimer(); // 这会设置初始的托盘图标
 
-  // 应用主题
+  // 应用主题：主窗口和浮动窗口通过信号跟随主题变化
+  themeManager->registerWindow(this);
+  connect(themeManager, &ThemeManager::themeChanged, this,
+          &MainWindow::onThemeApplied);
+  connect(themeManager, &ThemeManager::themeChanged, floatingTimer,
+          &FloatingTimer::setDarkTheme);
   applyTheme();
+  onThemeApplied(themeManager->isDark());
+  floatingTimer->setDarkTheme(themeManager->isDark());
+
+  // 离开检测
+  idleMonitor->setThreshold(idleThresholdMinutes * 60);
+  connect(idleMonitor, &IdleMonitor::idleStarted, this,
+          &MainWindow::onIdleStarted);
+  connect(idleMonitor, &IdleMonitor::idleEnded, this,
+          &MainWindow::onIdleEnded);
+
+  // 历史记录压缩：每5分钟检查一次，只在计时器空闲时进行
+  compactionTimer = new QTimer(this);
+  compactionWatcher = new QFutureWatcher<HistoryCompaction>(this);
+  connect(compactionTimer, &QTimer::timeout, this,
+          &MainWindow::compactHistory);
+  connect(compactionWatcher, &QFutureWatcher<HistoryCompaction>::finished,
+          this, [this]() {
+            const HistoryCompaction result = compactionWatcher->result();
+            sessionHistory.applyCompaction(result);
+            const qint64 coldUs = measureHistoryQuery(
+                queryMonthStart.addMonths(-1), queryMonthStart);
+            const qint64 hotUs = measureHistoryQuery(queryMonthStart, queryEnd);
+            qInfo("历史记录压缩: %lld 个月份, 磁盘 %lld -> %lld 字节, "
+                  "上月查询 %lld -> %lld 微秒, 本月查询 %lld -> %lld 微秒",
+                  qint64(result.months.size()), result.diskBefore,
+                  result.diskAfter, coldQueryUsBeforeCompaction, coldUs,
+                  hotQueryUsBeforeCompaction, hotUs);
+          });
+  compactionTimer->start(5 * 60 * 1000);
 }
 
 MainWindow::~MainWindow() {
+  compactionWatcher->waitForFinished(); // 压缩任务访问sessionHistory
   saveSettings();
   delete ui;
 }
 
+void MainWindow::handleCommandLine(const QStringList &arguments) {
+  AppCommandLine commandLine;
+  if (!commandLine.parse(arguments)) {
+    qWarning("忽略无法解析的命令行参数: %s",
+             qPrintable(commandLine.errorText()));
+    return;
+  }
+
+  // 没有任何命令的重复启动视为请求显示窗口
+  if (commandLine.showRequested() || !commandLine.hasTimerCommand()) {
+    showWindow();
+  }
+  if (commandLine.hasTheme()) {
+    saveSessionTheme(commandLine.theme());
+  }
+  if (commandLine.startRequested()) {
+    onStartButtonClicked();
+  }
+  if (commandLine.pauseRequested() && timer->isActive()) {
+    onPauseButtonClicked();
+  }
+}
+
 void MainWindow::createTrayIcon() {
   trayIcon = new QSystemTrayIcon(this);
 
@@ -102,14 +176,33 @@ void MainWindow::createTrayIcon() {
   trayMenu = new QMenu(this);
   QAction *showAction = new QAction("显示窗口", this);
   QAction *hideAction = new QAction("隐藏窗口", this);
+  QAction *statsAction = new QAction("统计", this);
+  followSystemAction = new QAction("跟随系统主题", this);
+  followSystemAction->setCheckable(true);
+  followSystemAction->setChecked(followSystemTheme);
+  followSystemAction->setEnabled(ThemeManager::canFollowSystem());
+  QAction *lockFloatingAction = new QAction("锁定浮动窗口", this);
+  lockFloatingAction->setCheckable(true);
+  lockFloatingAction->setChecked(floatingTimer->isLocked());
   QAction *quitAction = new QAction("退出", this);
 
   connect(showAction, &QAction::triggered, this, &MainWindow::showWindow);
   connect(hideAction, &QAction::triggered, this, &MainWindow::hideWindow);
+  connect(statsAction, &QAction::triggered, this, &MainWindow::showStatistics);
+  connect(followSystemAction, &QAction::toggled, this, [this](bool checked) {
+    followSystemTheme = checked;
+    applyTheme();
+    saveSettings();
+  });
+  connect(lockFloatingAction, &QAction::toggled, floatingTimer,
+          &FloatingTimer::setLocked);
   connect(quitAction, &QAction::triggered, qApp, &QApplication::quit);
 
   trayMenu->addAction(showAction);
   trayMenu->addAction(hideAction);
+  trayMenu->addAction(statsAction);
+  trayMenu->addAction(followSystemAction);
+  trayMenu->addAction(lockFloatingAction);
   trayMenu->addSeparator();
   trayMenu->addAction(quitAction);
 
@@ -122,6 +215,9 @@ void MainWindow::createTrayIcon() {
 
 void MainWindow::updateTimer() {
   remainingTime = remainingTime.addSecs(-1);
+  if (timer->isActive()) {
+    phaseRunningSeconds++;
+  }
   ui->timeLabel->setText(remainingTime.toString("mm:ss"));
 
   // 更新浮动窗口的时间显示
@@ -135,75 +231,66 @@ void MainWindow::updateTimer() {
                         .arg(remainingTime.minute());
   trayIcon->setToolTip(tooltip);
 
-  // 创建带进度条和时间显示的图标
-  QPixmap pixmap(250, 80); // 更长的图标提供更大显示空间
-  pixmap.fill(Qt::transparent);
-  QPainter painter(&pixmap);
-  painter.setRenderHint(QPainter::Antialiasing);
-
-  // 计算进度百分比
-  int totalSeconds = remainingTime.minute() * 60 + remainingTime.second();
+  // 托盘图标帧由后台线程提前渲染，这里只取出现成的帧
+  updateTrayIcon();
   int totalDuration = isWorkPhase ? workDuration : breakDuration;
-  int progress = 100 - (totalSeconds * 100) / totalDuration;
-
-  // 绘制左侧圆圈进度条
-  int circleSize = 40;
-  int circleX = 2;
-  int circleY = (pixmap.height() - circleSize) / 2;
-
-  // 绘制圆圈背景
-  painter.setBrush(isDarkTheme ? Qt::darkGray : Qt::lightGray);
-  painter.setPen(Qt::NoPen);
-  painter.drawEllipse(circleX, circleY, circleSize, circleSize);
-
-  // 绘制进度弧线
-  painter.setPen(QPen(isDarkTheme ? Qt::white : Qt::black, 3));
-  int startAngle = 90 * 16;                   // 从12点开始
-  int spanAngle = -progress * 360 / 100 * 16; // 顺时针绘制
-  painter.drawArc(circleX + 2, circleY + 2, circleSize - 4, circleSize - 4,
-                  startAngle, spanAngle);
 
-  // 在圆圈右侧绘制时间文本（只显示分钟数）
-  painter.setPen(isDarkTheme ? Qt::white : Qt::black);
-  QFont font("Arial", 100, QFont::Bold);
-  painter.setFont(font);
-
-  QString timeText = QString::number(remainingTime.minute());
-  QRect textRect(circleSize + 15, 0, pixmap.width() - circleSize - 15,
-                 pixmap.height());
-  painter.drawText(textRect, Qt::AlignCenter, timeText);
-
-  trayIcon->setIcon(QIcon(pixmap));
+  // 阶段结束前一分钟提示
+  if (remainingTime == QTime(0, 1) && totalDuration > 60 &&
+      timer->isActive()) {
+    playSound(ToneSynth::Warning);
+  }
 
   if (remainingTime == QTime(0, 0)) {
-    playSound();
     switchPhase();
   }
 }
 
 void MainWindow::onStartButtonClicked() {
   if (!timer->isActive()) {
-    timer->start(1000); // 1秒触发一次
+    if (!phaseStartTime.isValid()) {
+      phaseStartTime = QDateTime::currentDateTime();
+    }
+    timer->start(tickInterval); // 默认1秒触发一次
     ui->startButton->setEnabled(false);
     ui->pauseButton->setEnabled(true);
+    hookRunner->trigger(HookRunner::Start, hookPayload());
+    updateIdleMonitor();
   }
 }
 
 void MainWindow::onPauseButtonClicked() {
   if (timer->isActive()) {
     timer->stop();
+    phaseInterruptions++;
     ui->startButton->setEnabled(true);
     ui->pauseButton->setText("继续");
+    syncFloatingTimer();
+    hookRunner->trigger(HookRunner::Pause, hookPayload());
   } else {
+    if (autoPaused) {
+      recordAway(QDateTime::currentDateTime()); // 回来后直接点了继续
+    }
     timer->start();
     ui->startButton->setEnabled(false);
     ui->pauseButton->setText("暂停");
+    syncFloatingTimer();
+    QJsonObject payload = hookPayload();
+    payload["resumed"] = true;
+    hookRunner->trigger(HookRunner::Start, payload);
   }
+  updateIdleMonitor();
 }
 
 void MainWindow::onResetButtonClicked() {
   timer->stop();
   isWorkPhase = true;
+  autoPaused = false;
+  updateIdleMonitor();
+  phaseStartTime = QDateTime();
+  phaseInterruptions = 0;
+  phaseRunningSeconds = 0;
+  phaseAway.clear();
   workDuration = settings->value("workDuration", 25 * 60).toInt();
   breakDuration = settings->value("breakDuration", 5 * 60).toInt();
   remainingTime = QTime(0, workDuration / 60, workDuration % 60);
@@ -223,10 +310,10 @@ void MainWindow::onResetButtonClicked() {
 }
 
 void MainWindow::switchPhase() {
-  // 播放更显著的提示音
-  playSound();
-  QTimer::singleShot(500, this, [this]() { playSound(); });
-  QTimer::singleShot(1000, this, [this]() { playSound(); });
+  // 播放提示音（提示音本身包含重复的音符，足够显著）
+  playSound(isWorkPhase ? ToneSynth::WorkEnd : ToneSynth::BreakEnd);
+
+  recordPhaseInterval();
 
   if (isWorkPhase) {
     completedCycles++;
@@ -244,9 +331,7 @@ void MainWindow::switchPhase() {
     ui->phaseLabel->setText(displayText);
 
     // 显示弹窗提醒
-    ReminderDialog *dialog =
-        new ReminderDialog("休息结束！\n开始新的一轮工作 ⏰", this);
-    dialog->show();
+    showReminder("休息结束！\n开始新的一轮工作 ⏰");
 
     // 继续显示托盘消息
     trayIcon->showMessage("番茄时钟", "休息结束，开始工作！",
@@ -271,8 +356,7 @@ void MainWindow::switchPhase() {
       message = QString("工作完成！\n恭喜完成第%1个番茄钟 🎉\n现在开始休息 🌿")
                     .arg(completedCycles);
     }
-    ReminderDialog *dialog = new ReminderDialog(message, this);
-    dialog->show();
+    showReminder(message);
 
     // 继续显示托盘消息
     trayIcon->showMessage("番茄时钟",
@@ -283,6 +367,127 @@ void MainWindow::switchPhase() {
 
   ui->timeLabel->setText(remainingTime.toString("mm:ss"));
   saveSettings();
+  hookRunner->trigger(HookRunner::PhaseSwitch, hookPayload());
+  updateIdleMonitor();
+  emit phaseSwitched(isWorkPhase);
+}
+
+void MainWindow::updateIdleMonitor() {
+  idleMonitor->setActive((timer->isActive() && isWorkPhase) || autoPaused);
+}
+
+void MainWindow::onIdleStarted(const QDateTime &since) {
+  if (!timer->isActive() || !isWorkPhase) {
+    return;
+  }
+
+  // 休息期间就已离开、工作阶段自动开始时，离开只从本阶段开始算起
+  const QDateTime start =
+      phaseStartTime.isValid() ? qMax(since, phaseStartTime) : since;
+  timer->stop();
+  autoPaused = true;
+  awaySince = start;
+  phaseInterruptions++;
+
+  // 检测到离开时计时器已经多走了这段时间，加回剩余时间
+  const QTime fullTime(0, workDuration / 60, workDuration % 60);
+  const QTime restored =
+      remainingTime.addSecs(start.secsTo(QDateTime::currentDateTime()));
+  const QTime previous = remainingTime;
+  remainingTime = restored < fullTime ? restored : fullTime;
+  phaseRunningSeconds =
+      qMax(0, phaseRunningSeconds - previous.secsTo(remainingTime));
+  ui->timeLabel->setText(remainingTime.toString("mm:ss"));
+  syncFloatingTimer();
+  ui->startButton->setEnabled(true);
+  ui->pauseButton->setText("继续");
+  updateTrayIcon();
+
+  trayIcon->showMessage("番茄时钟", "检测到离开，已自动暂停",
+                        QSystemTrayIcon::Information, 3000);
+  QJsonObject payload = hookPayload();
+  payload["reason"] = "idle";
+  hookRunner->trigger(HookRunner::Pause, payload);
+}
+
+void MainWindow::onIdleEnded(const QDateTime &since, const QDateTime &until) {
+  Q_UNUSED(since);
+  if (autoPaused) {
+    recordAway(until);
+    trayIcon->showMessage("番茄时钟", "欢迎回来，点击继续开始计时",
+                          QSystemTrayIcon::Information, 3000);
+  }
+}
+
+void MainWindow::recordAway(const QDateTime &until) {
+  autoPaused = false;
+  // 离开作为时段的结构化数据保存，不混入主题记录
+  phaseAway.append({awaySince, until});
+  qInfo("离开 %lld 秒；空闲检测(%s) 共 %lld 次查询，平均 %lld 微秒",
+        awaySince.secsTo(until), qPrintable(idleMonitor->sourceName()),
+        idleMonitor->pollCount(), idleMonitor->averagePollUs());
+  updateIdleMonitor();
+}
+
+void MainWindow::syncFloatingTimer() {
+  floatingTimer->setTime(remainingTime);
+  if (timer->isActive() && floatingTimer->isVisible()) {
+    floatingTimer->startTimer();
+  } else {
+    floatingTimer->stopTimer();
+  }
+}
+
+QJsonObject MainWindow::hookPayload() const {
+  QJsonObject payload;
+  payload["phase"] = isWorkPhase ? "work" : "break";
+  payload["remainingSeconds"] = QTime(0, 0).secsTo(remainingTime);
+  payload["completedCycles"] = completedCycles;
+  payload["theme"] = currentSessionTheme;
+  return payload;
+}
+
+// 无人值守时弹窗不会被关闭，新的提醒替换旧的而不是堆积
+void MainWindow::showReminder(const QString &message) {
+  if (reminderDialog) {
+    reminderDialog->close(); // WA_DeleteOnClose
+  }
+  reminderDialog = new ReminderDialog(message, this);
+  themeManager->registerWindow(reminderDialog, "reminder_dialog");
+  reminderDialog->show();
+}
+
+void MainWindow::setTickInterval(int ms) {
+  tickInterval = ms;
+  if (timer->isActive()) {
+    timer->setInterval(ms);
+  }
+}
+
+void MainWindow::setAutoLockEnabled(bool enabled) {
+  ui->autoLockCheckBox->setChecked(enabled); // 通过复选框的信号保存设置
+  enableAutoLock = enabled;
+}
+
+void MainWindow::recordPhaseInterval() {
+  IntervalRecord record;
+  record.end = QDateTime::currentDateTime();
+  record.plannedSeconds = isWorkPhase ? workDuration : breakDuration;
+  record.start = phaseStartTime.isValid()
+                     ? phaseStartTime
+                     : record.end.addSecs(-record.plannedSeconds);
+  record.actualSeconds = phaseRunningSeconds;
+  record.interruptions = phaseInterruptions;
+  record.isWork = isWorkPhase;
+  record.theme = currentSessionTheme;
+  record.away = phaseAway;
+  statistics->recordInterval(record);
+
+  // 下一阶段紧接着开始
+  phaseStartTime = record.end;
+  phaseInterruptions = 0;
+  phaseRunningSeconds = 0;
+  phaseAway.clear();
 }
 
 void MainWindow::onSettingsButtonClicked() {
@@ -303,6 +508,15 @@ void MainWindow::onSettingsButtonClicked() {
     settings->setValue("breakDuration", breakDuration); // 立即保存
   }
 
+  int newIdleThreshold = QInputDialog::getInt(
+      this, "设置离开检测", "离开多久后自动暂停（分钟，0为关闭）:",
+      idleThresholdMinutes, 0, 60, 1, &ok);
+  if (ok) {
+    idleThresholdMinutes = newIdleThreshold;
+    settings->setValue("idleThresholdMinutes", idleThresholdMinutes);
+    idleMonitor->setThreshold(idleThresholdMinutes * 60);
+  }
+
   // 直接更新显示
   if (isWorkPhase) {
     remainingTime = QTime(0, workDuration / 60, workDuration % 60);
@@ -314,56 +528,32 @@ void MainWindow::onSettingsButtonClicked() {
 }
 
 void MainWindow::onThemeChanged() {
+  // 手动切换主题后不再跟随系统
+  followSystemTheme = false;
+  {
+    QSignalBlocker blocker(followSystemAction);
+    followSystemAction->setChecked(false);
+  }
   isDarkTheme = !isDarkTheme;
   applyTheme();
   saveSettings();
 }
 
 void MainWindow::applyTheme() {
-  // 使用QPalette来设置主题，避免样式表影响布局
-  QPalette palette;
-
-  if (isDarkTheme) {
-    // 深色主题
-    palette.setColor(QPalette::Window, QColor(43, 43, 43));        // 主窗口背景
-    palette.setColor(QPalette::WindowText, QColor(255, 255, 255)); // 文字颜色
-    palette.setColor(QPalette::Base, QColor(64, 64, 64));          // 控件背景
-    palette.setColor(QPalette::AlternateBase, QColor(53, 53, 53)); // 交替背景
-    palette.setColor(QPalette::ToolTipBase, QColor(255, 255, 255));
-    palette.setColor(QPalette::ToolTipText, QColor(43, 43, 43));
-    palette.setColor(QPalette::Text, QColor(255, 255, 255));       // 文本颜色
-    palette.setColor(QPalette::Button, QColor(64, 64, 64));        // 按钮背景
-    palette.setColor(QPalette::ButtonText, QColor(255, 255, 255)); // 按钮文字
-    palette.setColor(QPalette::BrightText, QColor(255, 0, 0));
-    palette.setColor(QPalette::Link, QColor(173, 216, 230));
-    palette.setColor(QPalette::Highlight, QColor(110, 110, 110)); // 选中背景
-    palette.setColor(QPalette::HighlightedText,
-                     QColor(255, 255, 255)); // 选中文字
-
-    ui->themeButton->setText("浅色主题");
+  // 调色板和样式表已由主题管理器预先生成，这里只切换模式，
+  // 不修改全局调色板，只有已注册的窗口会更新
+  // 获取不到系统配色方案时（Qt 6.5以下或平台未报告）使用保存的主题
+  if (followSystemTheme && ThemeManager::canFollowSystem()) {
+    themeManager->setMode(ThemeManager::FollowSystem);
   } else {
-    // 浅色主题（系统默认）
-    palette = QApplication::palette(); // 恢复系统默认主题
-    ui->themeButton->setText("深色主题");
-
-    // 确保重置所有必要的颜色
-    palette.setColor(QPalette::Window, QColor(240, 240, 240));
-    palette.setColor(QPalette::WindowText, Qt::black);
-    palette.setColor(QPalette::Base, Qt::white);
-    palette.setColor(QPalette::AlternateBase, QColor(233, 233, 233));
-    palette.setColor(QPalette::Text, Qt::black);
-    palette.setColor(QPalette::Button, QColor(240, 240, 240));
-    palette.setColor(QPalette::ButtonText, Qt::black);
+    themeManager->setMode(isDarkTheme ? ThemeManager::Dark
+                                      : ThemeManager::Light);
   }
+}
 
-  // 应用全局调色板，保持控件布局稳定
-  QApplication::setPalette(palette);
-  setPalette(palette);
-
-  // 浮动窗口也需要应用主题，但不改变其布局
-  if (floatingTimer && floatingTimer->isVisible()) {
-    floatingTimer->update();
-  }
+void MainWindow::onThemeApplied(bool dark) {
+  isDarkTheme = dark;
+  ui->themeButton->setText(isDarkTheme ? "浅色主题" : "深色主题");
 
   // 更新托盘图标以适应新主题
   updateTrayIcon();
@@ -373,16 +563,9 @@ void MainWindow::updateCycleCount() {
   ui->cycleLabel->setText(QString("已完成周期: %1").arg(completedCycles));
 }
 
-void MainWindow::playSound() {
-  QSoundEffect *effect = new QSoundEffect(this);
-  effect->setSource(QUrl::fromLocalFile("/System/Library/Sounds/Ping.aiff"));
-  effect->setVolume(volume);
-  effect->play();
-  connect(effect, &QSoundEffect::playingChanged, [effect]() {
-    if (!effect->isPlaying()) {
-      effect->deleteLater();
-    }
-  });
+void MainWindow::playSound(ToneSynth::Chime chime) {
+  // 提示音已在启动时生成，这里只是把它加入混音队列，不涉及文件读取
+  toneSynth->play(chime, volume);
 }
 
 void MainWindow::onTrayIconActivated(QSystemTrayIcon::ActivationReason reason) {
@@ -416,19 +599,30 @@ void MainWindow::closeEvent(QCloseEvent *event) {
 void MainWindow::saveSettings() {
   settings->setValue("workDuration", workDuration);
   settings->setValue("breakDuration", breakDuration);
-  settings->setValue("completedCycles", completedCycles);
+  settings->setValue("Timer/completedCycles", completedCycles);
   settings->setValue("isDarkTheme", isDarkTheme);
+  settings->setValue("followSystemTheme", followSystemTheme);
   settings->setValue("enableAutoLock", enableAutoLock);
   settings->setValue("volume", volume);
+  settings->setValue("idleThresholdMinutes", idleThresholdMinutes);
 }
 
 void MainWindow::loadSettings() {
   workDuration = settings->value("workDuration", 25 * 60).toInt();
   breakDuration = settings->value("breakDuration", 5 * 60).toInt();
-  completedCycles = settings->value("completedCycles", 0).toInt();
-  isDarkTheme = settings->value("isDarkTheme", false).toBool();
+  completedCycles = settings->value("Timer/completedCycles", 0).toInt();
+  // 新安装默认跟随系统，已有用户保留手动选择的主题；
+  // 无法跟随系统时新安装默认使用深色主题
+  const bool freshInstall = !settings->contains("isDarkTheme");
+  isDarkTheme = settings->value("isDarkTheme", true).toBool();
+  followSystemTheme =
+      settings
+          ->value("followSystemTheme",
+                  freshInstall && ThemeManager::canFollowSystem())
+          .toBool();
   enableAutoLock = settings->value("enableAutoLock", false).toBool();
   volume = settings->value("volume", 0.5f).toFloat(); // 加载音量设置
+  idleThresholdMinutes = settings->value("idleThresholdMinutes", 5).toInt();
 
   // 更新音量滑块和显示标签
   ui->volumeSlider->setValue(static_cast<int>(volume * 100));
@@ -474,6 +668,19 @@ void MainWindow::toggleFloatingWindow() {
   }
 }
 
+void MainWindow::showStatistics() {
+  if (!statisticsWindow) {
+    statisticsWindow = new StatisticsWindow(statistics, this);
+    statisticsWindow->setDarkTheme(isDarkTheme);
+    themeManager->registerWindow(statisticsWindow);
+    connect(themeManager, &ThemeManager::themeChanged, statisticsWindow,
+            &StatisticsWindow::setDarkTheme);
+  }
+  statisticsWindow->show();
+  statisticsWindow->raise();
+  statisticsWindow->activateWindow();
+}
+
 void MainWindow::resetFloatingWindowPosition() {
   if (floatingTimer) {
     floatingTimer->moveToDefaultPosition();
@@ -484,10 +691,8 @@ void MainWindow::resetFloatingWindowPosition() {
 // 保存当前会话主题
 void MainWindow::saveSessionTheme(const QString &theme) {
   currentSessionTheme = theme;
-  QSettings settings("PomodoroApp", "SessionThemes");
-  settings.beginGroup("Themes");
-  settings.setValue(QDateTime::currentDateTime().toString(Qt::ISODate), theme);
-  settings.endGroup();
+  sessionHistory.append(QDateTime::currentDateTime(), theme);
+  hookRunner->trigger(HookRunner::ThemeSaved, hookPayload());
 
   // 立即更新界面显示
   QString displayText =
@@ -498,19 +703,34 @@ void MainWindow::saveSessionTheme(const QString &theme) {
 // 获取指定时间范围内的主题记录
 QList<QPair<QDateTime, QString>>
 MainWindow::getSessionThemes(const QDateTime &from, const QDateTime &to) const {
-  QList<QPair<QDateTime, QString>> result;
-  QSettings settings("PomodoroApp", "SessionThemes");
-  settings.beginGroup("Themes");
-
-  foreach (const QString &key, settings.allKeys()) {
-    QDateTime dt = QDateTime::fromString(key, Qt::ISODate);
-    if (dt >= from && dt <= to) {
-      result.append(qMakePair(dt, settings.value(key).toString()));
-    }
+  // 在快照上读取，不会阻塞或干扰同时进行的追加
+  return sessionHistory.snapshot().range(from, to);
+}
+
+void MainWindow::compactHistory() {
+  if (timer->isActive() || compactionWatcher->isRunning() ||
+      !sessionHistory.needsCompaction()) {
+    return;
   }
 
-  settings.endGroup();
-  return result;
+  // 固定查询范围，压缩完成后重新计时时扫描的是同样的记录
+  const QDate today = QDate::currentDate();
+  queryMonthStart =
+      QDateTime(QDate(today.year(), today.month(), 1), QTime(0, 0));
+  queryEnd = QDateTime::currentDateTime();
+  coldQueryUsBeforeCompaction =
+      measureHistoryQuery(queryMonthStart.addMonths(-1), queryMonthStart);
+  hotQueryUsBeforeCompaction = measureHistoryQuery(queryMonthStart, queryEnd);
+  compactionWatcher->setFuture(
+      QtConcurrent::run([this]() { return sessionHistory.compact(); }));
+}
+
+qint64 MainWindow::measureHistoryQuery(const QDateTime &from,
+                                       const QDateTime &to) const {
+  QElapsedTimer elapsed;
+  elapsed.start();
+  getSessionThemes(from, to);
+  return elapsed.nsecsElapsed() / 1000;
 }
 
 // 导出主题记录到文件
@@ -543,13 +763,27 @@ void MainWindow::onVolumeChanged(int value) {
   ui->volumeValueLabel->setText(QString("%1%").arg(value));
 }
 
-// 更新托盘图标以适配当前主题
+// 当前计时状态，用于渲染托盘图标和浮动窗口
+FrameState MainWindow::currentFrameState() const {
+  FrameState state;
+  state.remainingSeconds = QTime(0, 0).secsTo(remainingTime);
+  state.totalSeconds = isWorkPhase ? workDuration : breakDuration;
+  state.isWorkPhase = isWorkPhase;
+  state.isDarkTheme = isDarkTheme;
+  return state;
+}
+
+// 更新托盘图标（带进度圆环和剩余分钟数），主题变化时也会调用
 void MainWindow::updateTrayIcon() {
   if (!trayIcon)
     return;
 
-  // 创建简单的单色图标适配主题
-  QPixmap pixmap(16, 16);
-  pixmap.fill(isDarkTheme ? Qt::white : Qt::black);
-  trayIcon->setIcon(QIcon(pixmap));
-}
\ No newline at end of file
+  const FrameState state = currentFrameState();
+  trayIcon->setIcon(QIcon(QPixmap::fromImage(
+      frameRenderer->frame(FrameRenderer::TrayFrame, state))));
+
+  // 计时进行中时让后台线程提前渲染接下来的帧
+  if (timer->isActive()) {
+    frameRenderer->prefetch(FrameRenderer::TrayFrame, state);
+  }
+}
@@ -5,9 +5,11 @@
 #include <QCheckBox>
 #include <QDialog>
 #include <QFileDialog>
+#include <QFutureWatcher>
 #include <QLabel>
 #include <QMainWindow>
 #include <QMenu>
+#include <QPointer>
 #include <QPropertyAnimation>
 #include <QPushButton>
 #include <QSettings>
@@ -16,7 +18,17 @@
 #include <QTimer>
 #include <QVBoxLayout>
 
-class FloatingTimer; // 前向声明浮动窗口类
+#include "frame_renderer.h"
+#include "hook_runner.h"
+#include "idle_monitor.h"
+#include "session_history.h"
+#include "statistics_engine.h"
+#include "theme_manager.h"
+#include "tone_synth.h"
+
+class FloatingTimer;    // 前向声明浮动窗口类
+class StatisticsWindow; // 统计窗口
+class ReminderDialog;   // 阶段切换提醒
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -31,6 +43,16 @@ public:
   MainWindow(QWidget *parent = nullptr);
   ~MainWindow();
 
+public slots:
+  // 处理命令行参数（包括其他实例转发过来的参数）
+  void handleCommandLine(const QStringList &arguments);
+  // 计时器每次触发的间隔（毫秒），每次触发倒计时减少1秒。浸泡测试用它加速时间
+  void setTickInterval(int ms);
+  void setAutoLockEnabled(bool enabled);
+
+signals:
+  void phaseSwitched(bool isWorkPhase); // 进入新的阶段
+
 private slots:
   void updateTimer();
   void onStartButtonClicked();
@@ -44,28 +66,59 @@ private slots:
   void toggleFloatingWindow();        // 切换浮动窗口显示
   void resetFloatingWindowPosition(); // 重置浮动窗口位置到左上角
   void onVolumeChanged(int value);    // 音量滑块改变
+  void showStatistics();              // 显示统计窗口
+  void compactHistory();              // 空闲时压缩历史记录
 
 private:
   Ui::MainWindow *ui;
   QTimer *timer;
   QTime remainingTime;
   bool isWorkPhase;
-  int workDuration;    // 工作时间（秒）
-  int breakDuration;   // 休息时间（秒）
-  int completedCycles; // 完成的周期数
-  bool isDarkTheme;    // 当前主题
-  bool enableAutoLock; // 是否启用自动锁屏
-  float volume;        // 提示音量 (0.0 - 1.0)
+  int workDuration;       // 工作时间（秒）
+  int breakDuration;      // 休息时间（秒）
+  int completedCycles;    // 完成的周期数
+  bool isDarkTheme;       // 当前主题
+  bool followSystemTheme; // 是否跟随系统深浅色
+  bool enableAutoLock;    // 是否启用自动锁屏
+  float volume;           // 提示音量 (0.0 - 1.0)
   QSystemTrayIcon *trayIcon;
   QMenu *trayMenu;
   QSettings *settings;
-  FloatingTimer *floatingTimer; // 浮动窗口
+  FloatingTimer *floatingTimer;       // 浮动窗口
+  ToneSynth *toneSynth;               // 内置提示音合成器
+  StatisticsEngine *statistics;       // 时段统计
+  StatisticsWindow *statisticsWindow; // 统计窗口（首次打开时创建）
+  ThemeManager *themeManager;         // 主题管理
+  FrameRenderer *frameRenderer;       // 托盘和浮动窗口的后台帧渲染
+  HookRunner *hookRunner;             // 外部事件钩子
+  IdleMonitor *idleMonitor;           // 离开检测
+  int idleThresholdMinutes;           // 离开多久后自动暂停，0为关闭
+  bool autoPaused;                    // 因离开而自动暂停
+  QDateTime awaySince;                // 离开的开始时间（按空闲时间回推）
+  QAction *followSystemAction;        // 托盘菜单：跟随系统主题
+  QPointer<ReminderDialog> reminderDialog; // 当前的提醒弹窗，同时最多一个
+  int tickInterval;                        // 计时器间隔（毫秒）
+
+  // 当前阶段的计时信息，用于记录统计
+  QDateTime phaseStartTime;
+  int phaseInterruptions;
+  int phaseRunningSeconds;   // 实际计时的秒数（不含暂停和离开）
+  QList<AwaySpan> phaseAway; // 本阶段的离开，随时段一起记入统计
 
   void createTrayIcon();
   void switchPhase();
-  void playSound();
+  void recordPhaseInterval(); // 记录刚结束的阶段
+  void playSound(ToneSynth::Chime chime);
+  void showReminder(const QString &message);
+  QJsonObject hookPayload() const; // 钩子事件中的计时器状态
+  void updateIdleMonitor();        // 只在工作阶段计时或自动暂停期间检测
+  void syncFloatingTimer();        // 浮动窗口的倒计时跟随主计时器启停
+  void onIdleStarted(const QDateTime &since);
+  void onIdleEnded(const QDateTime &since, const QDateTime &until);
+  void recordAway(const QDateTime &until); // 把离开的时段记入当前阶段
   void updateCycleCount();
   void applyTheme();
+  void onThemeApplied(bool dark); // 主题实际变化后更新界面
   void saveSettings();
   void loadSettings();
   void lockScreen();        // 锁屏函数
@@ -77,14 +130,25 @@ private:
                                                     const QDateTime &to) const;
   void exportSessionThemes(const QString &filePath, const QDateTime &from,
                            const QDateTime &to) const;
-  QString currentSessionTheme; // 当前会话主题
+  QString currentSessionTheme;   // 当前会话主题
+  SessionHistory sessionHistory; // 主题记录存储
+  QTimer *compactionTimer;       // 定期检查是否需要压缩
+  QFutureWatcher<HistoryCompaction> *compactionWatcher;
+  // 压缩前后查询同一时间范围：上个月（被压缩的冷数据）和本月（热数据）分别计时
+  QDateTime queryMonthStart;
+  QDateTime queryEnd;
+  qint64 coldQueryUsBeforeCompaction;
+  qint64 hotQueryUsBeforeCompaction;
+  // 主题查询的耗时（微秒）
+  qint64 measureHistoryQuery(const QDateTime &from, const QDateTime &to) const;
 
 protected:
   void closeEvent(QCloseEvent *event) override;
   void keyPressEvent(QKeyEvent *event) override;
 
 private:
-  void updateTrayIcon(); // 更新托盘图标以适配主题
+  void updateTrayIcon(); // 更新托盘图标
+  FrameState currentFrameState() const;
 };
 
 #endif // MAINWINDOW_H
\ No newline at end of file
@@ -1,12 +1,55 @@
-QT += widgets multimedia
+QT += widgets multimedia concurrent network
 TARGET = qt_pomodoro
 TEMPLATE = app
 SOURCES += main.cpp \
            mainwindow.cpp \
            reminder_dialog.cpp \
-           floating_timer.cpp
+           floating_timer.cpp \
+           tone_synth.cpp \
+           statistics_engine.cpp \
+           statistics_window.cpp \
+           command_line.cpp \
+           single_instance.cpp \
+           theme_manager.cpp \
+           frame_renderer.cpp \
+           session_history.cpp \
+           history_archive.cpp \
+           soak_runner.cpp \
+           report_generator.cpp \
+           hook_runner.cpp \
+           idle_monitor.cpp \
+           state_file.cpp
 HEADERS += mainwindow.h \
            reminder_dialog.h \
-           floating_timer.h
+           floating_timer.h \
+           tone_synth.h \
+           statistics_engine.h \
+           statistics_window.h \
+           command_line.h \
+           single_instance.h \
+           theme_manager.h \
+           frame_renderer.h \
+           session_history.h \
+           history_archive.h \
+           soak_runner.h \
+           report_generator.h \
+           hook_runner.h \
+           idle_monitor.h \
+           state_file.h
 FORMS += mainwindow.ui
-RESOURCES += resources.qrc
\ No newline at end of file
+RESOURCES += resources.qrc
+win32: LIBS += -lpsapi
+
+# 离开检测的空闲时间来源
+macx: LIBS += -framework IOKit -framework CoreFoundation
+unix:!macx {
+    CONFIG += link_pkgconfig
+    packagesExist(x11 xscrnsaver) {
+        PKGCONFIG += x11 xscrnsaver
+        DEFINES += POMODORO_HAVE_XSS
+    }
+    qtHaveModule(dbus) {
+        QT += dbus
+        DEFINES += POMODORO_HAVE_DBUS
+    }
+}
\ No newline at end of file
@@ -1,13 +1,11 @@
 #include "reminder_dialog.h"
 #include <QApplication>
 #include <QScreen>
-#include <QTimer>
 
 ReminderDialog::ReminderDialog(const QString &message, QWidget *parent)
     : QDialog(parent)
 {
     setupUI(message);
-    playAlertSound();
     
     // 设置窗体属性
     setWindowFlags(Qt::FramelessWindowHint | Qt::Dialog | Qt::WindowStaysOnTopHint);
@@ -27,7 +25,6 @@ ReminderDialog::ReminderDialog(const QString &message, QWidget *parent)
 ReminderDialog::~ReminderDialog()
 {
     delete fadeAnimation;
-    delete soundEffect;
 }
 
 void ReminderDialog::setupUI(const QString &message)
@@ -45,55 +42,17 @@ void ReminderDialog::setupUI(const QString &message)
     // 创建布局和控件
     QVBoxLayout *layout = new QVBoxLayout(this);
     
+    // 样式由主题管理器按当前主题统一设置（themes/reminder_dialog_*.qss）
     messageLabel = new QLabel(message, this);
+    messageLabel->setObjectName("messageLabel");
     messageLabel->setAlignment(Qt::AlignCenter);
-    messageLabel->setStyleSheet("font-size: 18px; font-weight: bold; color: #e74c3c;");
     
     okButton = new QPushButton("确定", this);
+    okButton->setObjectName("okButton");
     okButton->setFixedHeight(40);
-    okButton->setStyleSheet(
-        "QPushButton {"
-        "    background-color: #3498db;"
-        "    color: white;"
-        "    border: none;"
-        "    border-radius: 5px;"
-        "    font-size: 16px;"
-        "    font-weight: bold;"
-        "}"
-        "QPushButton:hover {"
-        "    background-color: #2980b9;"
-        "}"
-        "QPushButton:pressed {"
-        "    background-color: #21618c;"
-        "}"
-    );
     
     layout->addWidget(messageLabel);
     layout->addWidget(okButton);
-    
-    // 设置对话框样式
-    setStyleSheet(
-        "QDialog {"
-        "    background: qlineargradient(x1: 0, y1: 0, x2: 0, y2: 1,"
-        "                                stop: 0 #f9f9f9, stop: 1 #e8e8e8);"
-        "    border: 3px solid #e74c3c;"
-        "    border-radius: 10px;"
-        "}"
-    );
-}
-
-void ReminderDialog::playAlertSound()
-{
-    soundEffect = new QSoundEffect(this);
-    // 播放更明显的提示音
-    soundEffect->setSource(QUrl::fromLocalFile("/System/Library/Sounds/Submarine.aiff"));
-    soundEffect->setVolume(0.8f);
-    soundEffect->play();
-    
-    // 播放第二次声音以增强提醒效果
-    QTimer::singleShot(500, this, [this]() {
-        soundEffect->play();
-    });
 }
 
 void ReminderDialog::onOkButtonClicked()
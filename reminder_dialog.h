@@ -6,7 +6,6 @@
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QPropertyAnimation>
-#include <QSoundEffect>
 
 class ReminderDialog : public QDialog
 {
@@ -24,10 +23,8 @@ private:
     QLabel *messageLabel;
     QPushButton *okButton;
     QPropertyAnimation *fadeAnimation;
-    QSoundEffect *soundEffect;
     
     void setupUI(const QString &message);
-    void playAlertSound();
 };
 
 #endif // REMINDERDIALOG_H
\ No newline at end of file
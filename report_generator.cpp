@@ -0,0 +1,441 @@
+#include "report_generator.h"
+#include "statistics_engine.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QtConcurrent>
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+const char *CacheFileName = ".report-cache.json";
+// 缓存中记录原始历史（含模板）标识和生成日期的键，以点开头不会与报告文件名冲突
+const char *SourceKey = ".source";
+const char *GeneratedOnKey = ".generatedOn";
+
+using Escape = QString (*)(const QString &);
+
+QString escapeMarkdown(const QString &text) {
+  // 值会出现在表格单元格中
+  QString result = text;
+  return result.replace('|', "\\|").replace('\n', ' ');
+}
+
+QString escapeHtml(const QString &text) { return text.toHtmlEscaped(); }
+
+QString readResource(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    qWarning("ReportGenerator: 无法读取模板 %s", qPrintable(path));
+    return QString();
+  }
+  return QString::fromUtf8(file.readAll());
+}
+
+// 模板只在第一次使用时读取，之后所有报告共用
+const QString &reportTemplate(ReportGenerator::Format format) {
+  static const QString markdown = readResource(":/reports/report.md");
+  static const QString html = readResource(":/reports/report.html");
+  return format == ReportGenerator::Html ? html : markdown;
+}
+
+// 两个模板的摘要，计入缓存的历史标识：模板随程序更新后，
+// 上次已结束的周期也要重新计算指纹
+const QString &templatesKey() {
+  static const QString key = QString::fromLatin1(
+      QCryptographicHash::hash(
+          (reportTemplate(ReportGenerator::Markdown) +
+           reportTemplate(ReportGenerator::Html))
+              .toUtf8(),
+          QCryptographicHash::Sha1)
+          .toHex()
+          .left(8));
+  return key;
+}
+
+// 极简模板：{{name}}替换为转义后的值，{{#list}}...{{/list}}对列表中的
+// 每一项重复，{{^list}}...{{/list}}在列表为空时输出
+QString renderTemplate(const QString &text, const QVariantHash &values,
+                       Escape escape) {
+  QString out;
+  qsizetype pos = 0;
+  while (pos < text.size()) {
+    const qsizetype open = text.indexOf("{{", pos);
+    const qsizetype close = open < 0 ? -1 : text.indexOf("}}", open);
+    if (close < 0) {
+      out += text.mid(pos);
+      break;
+    }
+    out += text.mid(pos, open - pos);
+    const QString tag = text.mid(open + 2, close - open - 2).trimmed();
+    pos = close + 2;
+
+    if (!tag.startsWith('#') && !tag.startsWith('^')) {
+      out += escape(values.value(tag).toString());
+      continue;
+    }
+
+    const QString name = tag.mid(1);
+    const QString endTag = "{{/" + name + "}}";
+    const qsizetype end = text.indexOf(endTag, pos);
+    if (end < 0) {
+      break;
+    }
+    const QString inner = text.mid(pos, end - pos);
+    const QVariantList items = values.value(name).toList();
+    if (tag.startsWith('^')) {
+      if (items.isEmpty()) {
+        out += renderTemplate(inner, values, escape);
+      }
+    } else {
+      for (const QVariant &item : items) {
+        QVariantHash scope = values;
+        scope.insert(item.toHash());
+        out += renderTemplate(inner, scope, escape);
+      }
+    }
+    pos = end + endTag.size();
+  }
+  return out;
+}
+
+QString renderReport(const QVariantHash &context,
+                     ReportGenerator::Format format) {
+  QVariantHash values = context;
+  values["generatedAt"] =
+      QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm");
+  return renderTemplate(reportTemplate(format), values,
+                        format == ReportGenerator::Html ? escapeHtml
+                                                        : escapeMarkdown);
+}
+
+// 报告内容（生成时间除外）和模板的摘要，QJsonObject的键有序，结果稳定
+QByteArray fingerprint(const QVariantHash &context,
+                       ReportGenerator::Format format) {
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(QJsonDocument(QJsonObject::fromVariantHash(context))
+                   .toJson(QJsonDocument::Compact));
+  hash.addData(reportTemplate(format).toUtf8());
+  return hash.result().toHex();
+}
+
+QString hours(qint64 seconds) {
+  return QString::number(seconds / 3600.0, 'f', 1);
+}
+
+} // namespace
+
+ReportGenerator::ReportGenerator(const StatisticsEngine *engine)
+    : engine(engine) {}
+
+QDate ReportGenerator::periodStart(Period period, const QDate &date) {
+  if (period == Weekly) {
+    return StatisticsEngine::weekStart(date);
+  }
+  return QDate(date.year(), date.month(), 1);
+}
+
+QDate ReportGenerator::periodEnd(Period period, const QDate &start) {
+  if (period == Weekly) {
+    return start.addDays(6);
+  }
+  return start.addMonths(1).addDays(-1);
+}
+
+QString ReportGenerator::fileName(Period period, const QDate &start,
+                                  Format format) {
+  const QString suffix = format == Html ? ".html" : ".md";
+  if (period == Weekly) {
+    return "weekly-" + start.toString("yyyy-MM-dd") + suffix;
+  }
+  return "monthly-" + start.toString("yyyy-MM") + suffix;
+}
+
+bool ReportGenerator::parsePeriod(const QString &text, Period *period) {
+  if (text == "weekly") {
+    *period = Weekly;
+  } else if (text == "monthly") {
+    *period = Monthly;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool ReportGenerator::parseFormat(const QString &text, Format *format) {
+  if (text == "md" || text == "markdown") {
+    *format = Markdown;
+  } else if (text == "html") {
+    *format = Html;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// 截至date（含）连续有专注记录的天数
+int ReportGenerator::streakEndingAt(const QDate &date) const {
+  int streak = 0;
+  for (QDate d = date; engine->day(d).workCount > 0; d = d.addDays(-1)) {
+    streak++;
+  }
+  return streak;
+}
+
+QVariantHash ReportGenerator::context(Period period, const QDate &start) const {
+  static const char *weekdayNames[] = {"周一", "周二", "周三", "周四",
+                                       "周五", "周六", "周日"};
+  const QDate today = QDate::currentDate();
+  const QDate end = periodEnd(period, start);
+  const QDate last = qMin(end, today); // 当前周期只统计到今天
+
+  RollupBucket total;
+  int activeDays = 0;
+  int longestStreak = 0;
+  int streak = 0;
+  qint64 maxFocus = 0;
+  const QMap<QDate, RollupBucket> daily = engine->dailyRange(start, end);
+  for (auto it = daily.cbegin(); it != daily.cend(); ++it) {
+    total.merge(it.value());
+    maxFocus = qMax(maxFocus, it.value().focusSeconds);
+  }
+
+  QVariantList days;
+  for (QDate d = start; d <= last; d = d.addDays(1)) {
+    const RollupBucket bucket = daily.value(d);
+    if (bucket.workCount > 0) {
+      activeDays++;
+      longestStreak = qMax(longestStreak, ++streak);
+    } else {
+      streak = 0;
+    }
+
+    const double ratio = maxFocus > 0 ? double(bucket.focusSeconds) / maxFocus
+                                      : 0.0;
+    QVariantHash day;
+    day["date"] = d.toString("MM-dd");
+    day["weekday"] = QString(weekdayNames[d.dayOfWeek() - 1]);
+    day["minutes"] = bucket.focusSeconds / 60;
+    day["count"] = bucket.workCount;
+    day["bar"] = QString(qRound(ratio * 20), QChar(0x2588));
+    day["barWidth"] = qRound(ratio * 100);
+    days.append(day);
+  }
+
+  // 主题按专注时间从多到少排列
+  const QHash<QString, RollupBucket> themeBuckets =
+      engine->themeRange(start, end);
+  QList<QPair<QString, RollupBucket>> sortedThemes;
+  for (auto it = themeBuckets.cbegin(); it != themeBuckets.cend(); ++it) {
+    sortedThemes.append(qMakePair(it.key(), it.value()));
+  }
+  std::sort(sortedThemes.begin(), sortedThemes.end(),
+            [](const auto &a, const auto &b) {
+              if (a.second.focusSeconds != b.second.focusSeconds) {
+                return a.second.focusSeconds > b.second.focusSeconds;
+              }
+              return a.first < b.first;
+            });
+
+  QVariantList themes;
+  for (const auto &entry : sortedThemes) {
+    QVariantHash theme;
+    theme["name"] = entry.first.isEmpty() ? "未设置主题" : entry.first;
+    theme["hours"] = hours(entry.second.focusSeconds);
+    theme["count"] = entry.second.workCount;
+    theme["share"] = total.focusSeconds > 0
+                         ? qRound(entry.second.focusSeconds * 100.0 /
+                                  total.focusSeconds)
+                         : 0;
+    themes.append(theme);
+  }
+
+  QVariantHash values;
+  values["title"] = period == Weekly
+                        ? QString("番茄钟周报 %1 ~ %2")
+                              .arg(start.toString("yyyy-MM-dd"),
+                                   end.toString("yyyy-MM-dd"))
+                        : QString("番茄钟月报 %1年%2月")
+                              .arg(start.year())
+                              .arg(start.month());
+  values["from"] = start.toString("yyyy-MM-dd");
+  values["to"] = end.toString("yyyy-MM-dd");
+  values["focusHours"] = hours(total.focusSeconds);
+  values["workCount"] = total.workCount;
+  values["breakMinutes"] = total.breakSeconds / 60;
+  values["interruptions"] = total.interruptions;
+  values["activeDays"] = activeDays;
+  values["dailyAverage"] =
+      activeDays > 0 ? total.focusSeconds / 60 / activeDays : 0;
+  values["longestStreak"] = longestStreak;
+  // 今天还没有完成番茄钟时不算中断
+  values["currentStreak"] =
+      streakEndingAt(last == today && engine->day(today).workCount == 0
+                         ? today.addDays(-1)
+                         : last);
+  values["themes"] = themes;
+  values["days"] = days;
+  return values;
+}
+
+QString ReportGenerator::render(Period period, const QDate &date,
+                                Format format) const {
+  return renderReport(context(period, periodStart(period, date)), format);
+}
+
+bool ReportGenerator::generateAll(Period period, Format format,
+                                  const QString &outputDir, int *written,
+                                  int *skipped) const {
+  int writeCount = 0;
+  int skipCount = 0;
+  if (!QDir().mkpath(outputDir)) {
+    qWarning("ReportGenerator: 无法创建目录 %s", qPrintable(outputDir));
+    return false;
+  }
+
+  // 缓存记录每个报告文件对应的内容指纹
+  const QString cachePath = outputDir + "/" + CacheFileName;
+  QJsonObject cache;
+  QFile cacheFile(cachePath);
+  if (cacheFile.open(QIODevice::ReadOnly)) {
+    cache = QJsonDocument::fromJson(cacheFile.readAll()).object();
+    cacheFile.close();
+  }
+
+  // 原始历史和模板自上次生成以来都没有变化时，上次就已结束的周期不需要任何计算
+  const QDate today = QDate::currentDate();
+  const QString source = engine->sourceKey() + ":" + templatesKey();
+  const QDate lastRun =
+      QDate::fromString(cache.value(GeneratedOnKey).toString(), Qt::ISODate);
+  const bool sourceUnchanged =
+      lastRun.isValid() && cache.value(SourceKey).toString() == source;
+
+  const QDate first = engine->firstRecordedDay().isValid()
+                          ? qMin(engine->firstRecordedDay(), today)
+                          : today;
+  bool ok = true;
+  for (QDate start = periodStart(period, first); start <= today;
+       start = periodEnd(period, start).addDays(1)) {
+    const QString name = fileName(period, start, format);
+    const QString path = outputDir + "/" + name;
+    if (sourceUnchanged && periodEnd(period, start) < lastRun &&
+        cache.contains(name) && QFile::exists(path)) {
+      skipCount++;
+      continue;
+    }
+
+    const QVariantHash values = context(period, start);
+    const QString hash = QString::fromLatin1(fingerprint(values, format));
+
+    // 已结束的周期数据不会再变化，命中缓存时不再渲染和写入
+    if (periodEnd(period, start) < today && cache.value(name) == hash &&
+        QFile::exists(path)) {
+      skipCount++;
+      continue;
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+      ok = false;
+      continue;
+    }
+    file.write(renderReport(values, format).toUtf8());
+    if (!file.commit()) {
+      ok = false;
+      continue;
+    }
+    cache[name] = hash;
+    writeCount++;
+  }
+  cache[SourceKey] = source;
+  cache[GeneratedOnKey] = today.toString(Qt::ISODate);
+
+  QSaveFile output(cachePath);
+  if (output.open(QIODevice::WriteOnly)) {
+    output.write(QJsonDocument(cache).toJson(QJsonDocument::Indented));
+    ok = output.commit() && ok;
+  }
+
+  if (written) {
+    *written = writeCount;
+  }
+  if (skipped) {
+    *skipped = skipCount;
+  }
+  return ok;
+}
+
+bool ReportGenerator::generateBatch(Period period, Format format,
+                                    const QStringList &dataDirs,
+                                    const QString &outputDir) {
+  QElapsedTimer elapsed;
+  elapsed.start();
+
+  const QStringList dirs = dataDirs.isEmpty() ? QStringList(QString())
+                                              : dataDirs;
+
+  // 默认的数据目录都叫QtPomodoro，子目录名加上完整路径的哈希才不会互相覆盖
+  QList<QPair<QString, QString>> jobs; // 数据目录和输出目录
+  QSet<QString> seen;
+  for (const QString &dir : dirs) {
+    if (dir.isEmpty()) {
+      jobs.append(qMakePair(dir, outputDir));
+      continue;
+    }
+    const QFileInfo info(dir);
+    if (!info.isDir()) {
+      qWarning("ReportGenerator: 数据目录 %s 不存在", qPrintable(dir));
+      return false;
+    }
+    const QString canonical = info.canonicalFilePath();
+    if (seen.contains(canonical)) {
+      qWarning("ReportGenerator: 数据目录 %s 重复指定", qPrintable(dir));
+      return false;
+    }
+    seen.insert(canonical);
+
+    QString target = outputDir;
+    if (dirs.size() > 1) {
+      const QByteArray hash = QCryptographicHash::hash(
+          canonical.toUtf8(), QCryptographicHash::Sha1);
+      target += "/" + QFileInfo(canonical).fileName() + "-" +
+                QString::fromLatin1(hash.toHex().left(8));
+    }
+    jobs.append(qMakePair(dir, target));
+  }
+
+  std::atomic<int> written(0);
+  std::atomic<int> skipped(0);
+  auto generate = [&](const QPair<QString, QString> &job) {
+    const QString &dir = job.first;
+    const QString &target = job.second;
+    // 只读打开：不在别人的数据目录中创建或改写任何文件
+    StatisticsEngine engine(dir, StatisticsEngine::ReadOnly);
+    int dirWritten = 0;
+    int dirSkipped = 0;
+    const bool ok = ReportGenerator(&engine).generateAll(
+        period, format, target, &dirWritten, &dirSkipped);
+    written += dirWritten;
+    skipped += dirSkipped;
+    if (!ok) {
+      qWarning("ReportGenerator: %s 的报告生成失败", qPrintable(dir));
+    }
+    return ok;
+  };
+
+  const QList<bool> results =
+      QtConcurrent::blockingMapped<QList<bool>>(jobs, generate);
+  qInfo("ReportGenerator: %lld 个数据目录, 写入 %d 份报告, 缓存跳过 %d 份 "
+        "(%lld ms)",
+        qint64(dirs.size()), written.load(), skipped.load(),
+        elapsed.elapsed());
+  return !results.contains(false);
+}
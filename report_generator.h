@@ -0,0 +1,49 @@
+#ifndef REPORT_GENERATOR_H
+#define REPORT_GENERATOR_H
+
+#include <QDate>
+#include <QString>
+#include <QStringList>
+#include <QVariantHash>
+
+class StatisticsEngine;
+
+// 周报/月报生成器：从统计汇总计算周期数据，再用资源中的模板
+// (:/reports/report.md、report.html) 渲染为Markdown或HTML
+class ReportGenerator {
+public:
+  enum Period { Weekly, Monthly };
+  enum Format { Markdown, Html };
+
+  explicit ReportGenerator(const StatisticsEngine *engine);
+
+  // 渲染包含date的那个周期
+  QString render(Period period, const QDate &date, Format format) const;
+
+  // 在outputDir中生成从第一条记录到今天的所有周期报告。
+  // 已经结束的周期数据不再变化，缓存指纹一致时跳过，只重新生成当前周期
+  bool generateAll(Period period, Format format, const QString &outputDir,
+                   int *written = nullptr, int *skipped = nullptr) const;
+
+  // 为多个数据目录并行生成报告，每个目录输出到outputDir下的子目录
+  // （目录名-完整路径哈希的前8位）；只有一个目录时直接输出到outputDir。
+  // 空字符串表示本机的数据目录。数据目录只读打开，不存在或重复时失败
+  static bool generateBatch(Period period, Format format,
+                            const QStringList &dataDirs,
+                            const QString &outputDir);
+
+  static QDate periodStart(Period period, const QDate &date);
+  static QDate periodEnd(Period period, const QDate &start);
+  static QString fileName(Period period, const QDate &start, Format format);
+
+  static bool parsePeriod(const QString &text, Period *period);
+  static bool parseFormat(const QString &text, Format *format);
+
+private:
+  QVariantHash context(Period period, const QDate &start) const;
+  int streakEndingAt(const QDate &date) const;
+
+  const StatisticsEngine *engine;
+};
+
+#endif // REPORT_GENERATOR_H
@@ -0,0 +1,310 @@
+#include "session_history.h"
+#include "state_file.h"
+#include <QFileInfo>
+#include <QSet>
+#include <QSettings>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+const int SegmentCapacity = 1024; // 每段的记录数
+
+using ThemeList = QList<QPair<QDateTime, QString>>;
+
+struct ScanTask {
+  std::shared_ptr<const HistorySegment> segment; // 为空时读取磁盘上的压缩段
+  int count; // 快照可见的条数
+  ArchiveSegment archived;
+};
+
+} // namespace
+
+HistorySegment::HistorySegment(int capacity)
+    : entries(new HistoryEntry[capacity]), capacity(capacity), count(0),
+      minTs(0), maxTs(0) {}
+
+bool HistorySegment::append(const HistoryEntry &entry) {
+  const int index = count.load(std::memory_order_relaxed);
+  if (index >= capacity) {
+    return false;
+  }
+  entries[index] = entry;
+  count.store(index + 1, std::memory_order_release); // 发布新条目
+  return true;
+}
+
+void HistorySegment::seal() {
+  const int n = size();
+  if (n == 0) {
+    return;
+  }
+  minTs = maxTs = entries[0].timestampMs;
+  for (int i = 1; i < n; ++i) {
+    minTs = std::min(minTs, entries[i].timestampMs);
+    maxTs = std::max(maxTs, entries[i].timestampMs);
+  }
+}
+
+qint64 HistorySnapshot::size() const {
+  qint64 total = 0;
+  for (const ArchiveSegment &segment : archived) {
+    total += segment.count;
+  }
+  for (int i = 0; i < segments.size(); ++i) {
+    total += i == segments.size() - 1 ? tailCount : segments[i]->size();
+  }
+  return total;
+}
+
+ThemeList HistorySnapshot::range(const QDateTime &from,
+                                 const QDateTime &to) const {
+  const qint64 fromMs = from.toMSecsSinceEpoch();
+  const qint64 toMs = to.toMSecsSinceEpoch();
+
+  // 压缩段和封存段按时间范围筛选，尾段总是需要扫描
+  QList<ScanTask> tasks;
+  for (const ArchiveSegment &segment : archived) {
+    if (segment.maxTs < fromMs || segment.minTs > toMs) {
+      continue;
+    }
+    tasks.append({nullptr, segment.count, segment});
+  }
+  for (int i = 0; i < segments.size(); ++i) {
+    const bool isTail = i == segments.size() - 1;
+    const auto &segment = segments[i];
+    if (!isTail &&
+        (segment->maxTimestamp() < fromMs || segment->minTimestamp() > toMs)) {
+      continue;
+    }
+    tasks.append({segment, isTail ? tailCount : segment->size(), {}});
+  }
+
+  auto scan = [fromMs, toMs](const ScanTask &task) {
+    ThemeList result;
+    auto collect = [&](const HistoryEntry &entry) {
+      if (entry.timestampMs >= fromMs && entry.timestampMs <= toMs) {
+        result.append(qMakePair(
+            QDateTime::fromMSecsSinceEpoch(entry.timestampMs), entry.theme));
+      }
+    };
+    if (!task.segment) {
+      // 压缩段在各自的任务中解压，互不阻塞
+      const QList<HistoryEntry> entries =
+          HistoryArchive::readSegment(task.archived);
+      for (const HistoryEntry &entry : entries) {
+        collect(entry);
+      }
+      return result;
+    }
+    for (int i = 0; i < task.count; ++i) {
+      collect(task.segment->at(i));
+    }
+    return result;
+  };
+  auto merge = [](ThemeList &result, const ThemeList &part) {
+    result.append(part);
+  };
+
+  ThemeList result = QtConcurrent::blockingMappedReduced<ThemeList>(
+      tasks, scan, merge, QtConcurrent::OrderedReduce);
+  std::stable_sort(result.begin(), result.end(),
+                   [](const auto &a, const auto &b) { return a.first < b.first; });
+  return result;
+}
+
+SessionHistory::SessionHistory(const QString &directory)
+    : archive(directory), standalone(!directory.isEmpty()) {
+  if (!standalone && !StateFile::isIsolated()) {
+    migrateSettings();
+  }
+  load();
+}
+
+void SessionHistory::migrateSettings() {
+  if (!archive.isEmpty()) {
+    return;
+  }
+
+  QSettings settings("PomodoroApp", "SessionThemes");
+  settings.beginGroup("Themes");
+  const QStringList keys = settings.allKeys();
+  if (keys.isEmpty()) {
+    return;
+  }
+
+  // 键为ISO格式的时间，allKeys()按字典序返回即按时间顺序
+  bool ok = true;
+  foreach (const QString &key, keys) {
+    QDateTime dt = QDateTime::fromString(key, Qt::ISODate);
+    if (dt.isValid()) {
+      const HistoryEntry entry{dt.toMSecsSinceEpoch(),
+                               settings.value(key).toString()};
+      ok = archive.append(entry) && ok;
+    }
+  }
+
+  // 全部写入存档后才删除旧数据
+  if (ok) {
+    settings.remove("");
+  }
+  settings.endGroup();
+}
+
+void SessionHistory::load() {
+  // 压缩段只读取头部，记录在用到时才解压
+  const QList<ArchiveSegment> index =
+      standalone ? QList<ArchiveSegment>() : loadIndex();
+  auto initial = std::make_shared<State>();
+  int headersRead = 0;
+  initial->archived = archive.sealedSegments(index, &headersRead);
+  if (!standalone &&
+      (headersRead > 0 || initial->archived.size() != index.size())) {
+    saveIndex(initial->archived);
+  }
+  initial->tail = std::make_shared<HistorySegment>(SegmentCapacity);
+  std::atomic_store(&state, std::shared_ptr<const State>(initial));
+
+  for (const HistoryEntry &entry : archive.readHotEntries()) {
+    appendToMemory(entry);
+  }
+}
+
+QList<ArchiveSegment> SessionHistory::loadIndex() {
+  QSettings settings(StateFile::path(), StateFile::format());
+  QList<ArchiveSegment> index;
+  const QVariantList list = settings.value("History/segments").toList();
+  for (const QVariant &value : list) {
+    const QVariantMap item = value.toMap();
+    ArchiveSegment segment;
+    segment.path = item.value("file").toString();
+    segment.count = item.value("count").toInt();
+    segment.minTs = item.value("minTs").toLongLong();
+    segment.maxTs = item.value("maxTs").toLongLong();
+    segment.bytes = item.value("bytes").toLongLong();
+    index.append(segment);
+  }
+  return index;
+}
+
+void SessionHistory::saveIndex(const QVector<ArchiveSegment> &segments) {
+  QVariantList list;
+  for (const ArchiveSegment &segment : segments) {
+    QVariantMap item;
+    item["file"] = QFileInfo(segment.path).fileName();
+    item["count"] = segment.count;
+    item["minTs"] = segment.minTs;
+    item["maxTs"] = segment.maxTs;
+    item["bytes"] = segment.bytes;
+    list.append(item);
+  }
+  QSettings settings(StateFile::path(), StateFile::format());
+  settings.setValue("History/segments", list);
+}
+
+void SessionHistory::append(const QDateTime &time, const QString &theme) {
+  const HistoryEntry entry{time.toMSecsSinceEpoch(), theme};
+  archive.append(entry);
+  appendToMemory(entry);
+}
+
+void SessionHistory::appendToMemory(const HistoryEntry &entry) {
+  std::shared_ptr<const State> current = std::atomic_load(&state);
+  if (current->tail->append(entry)) {
+    return;
+  }
+
+  // 尾段已满：封存后连同新的尾段一起发布新的状态
+  current->tail->seal();
+  auto next = std::make_shared<State>();
+  next->archived = current->archived;
+  next->sealed = current->sealed;
+  next->sealed.append(current->tail);
+  next->tail = std::make_shared<HistorySegment>(SegmentCapacity);
+  next->tail->append(entry);
+  std::atomic_store(&state, std::shared_ptr<const State>(next));
+}
+
+HistorySnapshot SessionHistory::snapshot() const {
+  std::shared_ptr<const State> current = std::atomic_load(&state);
+
+  HistorySnapshot snapshot;
+  snapshot.archived = current->archived;
+  snapshot.segments = current->sealed;
+  snapshot.segments.append(current->tail);
+  snapshot.tailCount = current->tail->size();
+  return snapshot;
+}
+
+bool SessionHistory::needsCompaction() const {
+  return !archive.hotMonthsBefore(QDate::currentDate()).isEmpty();
+}
+
+HistoryCompaction SessionHistory::compact() {
+  HistoryCompaction result;
+  result.diskBefore = archive.diskUsage();
+
+  // 本月保持为热文件，只压缩之前的月份
+  foreach (const QString &month, archive.hotMonthsBefore(QDate::currentDate())) {
+    ArchiveSegment segment;
+    if (archive.sealMonth(month, &segment)) {
+      result.segments.append(segment);
+      result.months.append(month);
+    } else {
+      qWarning("SessionHistory: 压缩 %s 失败", qPrintable(month));
+    }
+  }
+
+  result.diskAfter = archive.diskUsage();
+  return result;
+}
+
+void SessionHistory::applyCompaction(const HistoryCompaction &result) {
+  if (result.months.isEmpty()) {
+    return;
+  }
+  std::shared_ptr<const State> current = std::atomic_load(&state);
+  auto next = std::make_shared<State>();
+
+  // 同一个月重新封存时新一代的段替换旧段。旧段文件仍留在磁盘上，
+  // 已有的快照照常读取，下次打开存档时删除
+  const QSet<QString> months(result.months.begin(), result.months.end());
+  for (const ArchiveSegment &segment : current->archived) {
+    if (!months.contains(HistoryArchive::segmentMonth(segment.path))) {
+      next->archived.append(segment);
+    }
+  }
+  next->archived.append(result.segments);
+  std::sort(next->archived.begin(), next->archived.end(),
+            [](const ArchiveSegment &a, const ArchiveSegment &b) {
+              return a.minTs < b.minTs;
+            });
+
+  // 重新组织内存中的段，只保留尚未封存月份的记录。
+  // 旧的段可能仍被读取者的快照引用，因此不能原地修改
+  next->tail = std::make_shared<HistorySegment>(SegmentCapacity);
+  auto keep = [&](const HistoryEntry &entry) {
+    if (months.contains(HistoryArchive::monthOf(entry.timestampMs))) {
+      return;
+    }
+    if (!next->tail->append(entry)) {
+      next->tail->seal();
+      next->sealed.append(next->tail);
+      next->tail = std::make_shared<HistorySegment>(SegmentCapacity);
+      next->tail->append(entry);
+    }
+  };
+  for (const auto &segment : current->sealed) {
+    for (int i = 0; i < segment->size(); ++i) {
+      keep(segment->at(i));
+    }
+  }
+  for (int i = 0; i < current->tail->size(); ++i) {
+    keep(current->tail->at(i));
+  }
+
+  std::atomic_store(&state, std::shared_ptr<const State>(next));
+  if (!standalone) {
+    saveIndex(next->archived);
+  }
+}
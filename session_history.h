@@ -0,0 +1,101 @@
+#ifndef SESSION_HISTORY_H
+#define SESSION_HISTORY_H
+
+#include "history_archive.h"
+#include <QDateTime>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+// 固定容量、只追加的记录段。写入者填好槽位后才发布新的条数，
+// 读取者只访问已发布的条目，因此双方都不需要加锁
+class HistorySegment {
+public:
+  explicit HistorySegment(int capacity);
+
+  bool append(const HistoryEntry &entry); // 仅写入者调用，已满时返回false
+  int size() const { return count.load(std::memory_order_acquire); }
+  const HistoryEntry &at(int index) const { return entries[index]; }
+
+  // 封存时计算时间范围，用于跳过不相关的段。
+  // 封存发生在段发布到封存列表之前，读取者只对封存列表中的段读取范围
+  void seal();
+  qint64 minTimestamp() const { return minTs; }
+  qint64 maxTimestamp() const { return maxTs; }
+
+private:
+  std::unique_ptr<HistoryEntry[]> entries;
+  int capacity;
+  std::atomic<int> count;
+  qint64 minTs;
+  qint64 maxTs;
+};
+
+// 历史记录的不可变视图：磁盘上的压缩段、内存中的封存段，加上尾段在快照时刻的条数。
+// 快照之后的追加对它不可见，可以在任意线程中并行扫描
+class HistorySnapshot {
+public:
+  HistorySnapshot() : tailCount(0) {}
+
+  qint64 size() const;
+  // 并行扫描各段（时间范围不相交的段直接跳过），最后按时间顺序合并结果
+  QList<QPair<QDateTime, QString>> range(const QDateTime &from,
+                                         const QDateTime &to) const;
+
+private:
+  friend class SessionHistory;
+
+  QVector<ArchiveSegment> archived; // 已压缩的历史月份
+  QVector<std::shared_ptr<const HistorySegment>> segments; // 最后一个为尾段
+  int tailCount;
+};
+
+// 一次压缩的结果，由工作线程生成，回到写入者线程后应用
+struct HistoryCompaction {
+  QVector<ArchiveSegment> segments; // 新封存的月份
+  QStringList months;               // 对应的月份，这些记录将移出内存
+  qint64 diskBefore = 0;
+  qint64 diskAfter = 0;
+};
+
+// 主题记录存储：单一写入者无锁追加，读取者通过快照隔离。
+// 内存中只保留未封存的月份，更早的月份在空闲时压缩到磁盘
+class SessionHistory {
+public:
+  // 指定目录时使用独立的存档（测试用），不迁移旧设置也不读写状态文件中的索引
+  explicit SessionHistory(const QString &directory = QString());
+
+  void append(const QDateTime &time, const QString &theme);
+  HistorySnapshot snapshot() const;
+
+  // 是否有早于本月、尚未压缩的月份
+  bool needsCompaction() const;
+  // 压缩早于本月的热文件，只访问磁盘，可在工作线程调用
+  HistoryCompaction compact();
+  // 在写入者线程发布压缩后的状态，并释放已封存月份占用的内存
+  void applyCompaction(const HistoryCompaction &result);
+
+private:
+  struct State {
+    QVector<ArchiveSegment> archived;
+    QVector<std::shared_ptr<const HistorySegment>> sealed;
+    std::shared_ptr<HistorySegment> tail;
+  };
+
+  void appendToMemory(const HistoryEntry &entry);
+  void load();
+  void migrateSettings(); // 从旧的QSettings存储迁移到存档
+  // 状态文件中缓存的封存段头部，启动时不必逐个打开封存段
+  static QList<ArchiveSegment> loadIndex();
+  static void saveIndex(const QVector<ArchiveSegment> &segments);
+
+  HistoryArchive archive;
+  bool standalone; // 使用独立目录，不触碰应用的设置和状态文件
+
+  std::shared_ptr<const State> state; // 通过std::atomic_load/atomic_store发布
+};
+
+#endif // SESSION_HISTORY_H
@@ -0,0 +1,120 @@
+#include "single_instance.h"
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QThread>
+
+namespace {
+
+// 按用户区分，不同用户可以各自运行一个实例
+QString instanceKey() {
+  QString user = qEnvironmentVariable("USER");
+  if (user.isEmpty()) {
+    user = qEnvironmentVariable("USERNAME");
+  }
+  return QString("QtPomodoro-%1").arg(user);
+}
+
+} // namespace
+
+SingleInstance::SingleInstance(QObject *parent)
+    : QObject(parent), serverName(instanceKey()),
+      lockFile(QDir::temp().filePath(instanceKey() + ".lock")),
+      server(nullptr), receiverReady(false) {
+  // 只根据持有进程是否存活判断锁是否失效，不按时间过期
+  lockFile.setStaleLockTime(0);
+}
+
+SingleInstance::~SingleInstance() {
+  if (server) {
+    server->close();
+  }
+}
+
+bool SingleInstance::tryAcquire() { return lockFile.tryLock(0); }
+
+bool SingleInstance::listen() {
+  // 持有锁时残留的套接字一定来自已退出的进程
+  QLocalServer::removeServer(serverName);
+
+  server = new QLocalServer(this);
+  server->setSocketOptions(QLocalServer::UserAccessOption);
+  if (!server->listen(serverName)) {
+    qWarning("SingleInstance: 无法监听 %s: %s", qPrintable(serverName),
+             qPrintable(server->errorString()));
+    return false;
+  }
+
+  connect(server, &QLocalServer::newConnection, this,
+          &SingleInstance::onNewConnection);
+  return true;
+}
+
+bool SingleInstance::forward(const QStringList &arguments, int timeoutMs) {
+  QElapsedTimer elapsed;
+  elapsed.start();
+
+  // 主实例可能刚拿到锁还没开始监听，短暂重试
+  QLocalSocket socket;
+  while (true) {
+    socket.connectToServer(serverName);
+    if (socket.waitForConnected(timeoutMs)) {
+      break;
+    }
+    if (elapsed.elapsed() >= timeoutMs) {
+      return false;
+    }
+    QThread::msleep(20);
+  }
+
+  QByteArray payload;
+  QDataStream out(&payload, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_6_0);
+  out << arguments;
+
+  socket.write(payload);
+  if (!socket.waitForBytesWritten(timeoutMs)) {
+    return false;
+  }
+  socket.disconnectFromServer();
+  return true;
+}
+
+void SingleInstance::onNewConnection() {
+  while (QLocalSocket *socket = server->nextPendingConnection()) {
+    connect(socket, &QLocalSocket::disconnected, socket,
+            &QLocalSocket::deleteLater);
+    connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+      QDataStream in(socket);
+      in.setVersion(QDataStream::Qt_6_0);
+
+      // 数据可能分多次到达，读取不完整时等待下一次readyRead
+      in.startTransaction();
+      QStringList arguments;
+      in >> arguments;
+      if (!in.commitTransaction()) {
+        return;
+      }
+      deliver(arguments);
+    });
+  }
+}
+
+void SingleInstance::setReceiverReady() {
+  receiverReady = true;
+  const QList<QStringList> pending = pendingArguments;
+  pendingArguments.clear();
+  for (const QStringList &arguments : pending) {
+    emit argumentsReceived(arguments);
+  }
+}
+
+void SingleInstance::deliver(const QStringList &arguments) {
+  if (!receiverReady) {
+    pendingArguments.append(arguments);
+    return;
+  }
+  emit argumentsReceived(arguments);
+}
@@ -0,0 +1,45 @@
+#ifndef SINGLE_INSTANCE_H
+#define SINGLE_INSTANCE_H
+
+#include <QList>
+#include <QLockFile>
+#include <QObject>
+#include <QStringList>
+
+class QLocalServer;
+
+// 单实例保护：第一个实例持有锁文件并监听本地套接字，
+// 之后启动的实例只把命令行参数转发给它，然后立即退出
+class SingleInstance : public QObject {
+  Q_OBJECT
+
+public:
+  explicit SingleInstance(QObject *parent = nullptr);
+  ~SingleInstance();
+
+  // 尝试成为主实例，已有实例在运行时返回false（不需要事件循环）
+  bool tryAcquire();
+  // 主实例开始接收转发的参数，在setReceiverReady()之前收到的参数先排队
+  bool listen();
+  // 接收者已经连接好：发出排队的参数，之后收到的参数直接发出
+  void setReceiverReady();
+  // 把参数转发给主实例，成功时返回true
+  bool forward(const QStringList &arguments, int timeoutMs = 1000);
+
+signals:
+  void argumentsReceived(const QStringList &arguments);
+
+private slots:
+  void onNewConnection();
+
+private:
+  void deliver(const QStringList &arguments);
+
+  QString serverName;
+  QLockFile lockFile;
+  QLocalServer *server;
+  bool receiverReady;
+  QList<QStringList> pendingArguments;
+};
+
+#endif // SINGLE_INSTANCE_H
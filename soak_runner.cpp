@@ -0,0 +1,260 @@
+#include "soak_runner.h"
+#include "frame_renderer.h"
+#include "idle_monitor.h"
+#include "mainwindow.h"
+#include "statistics_window.h"
+#include "theme_manager.h"
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSet>
+#include <QSysInfo>
+#include <QWidget>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+namespace {
+
+const int CyclesPerDay = 8; // 每个模拟日的工作+休息周期数
+const int ReportFormat = 1;
+
+} // namespace
+
+SoakRunner::SoakRunner(MainWindow *window, int days, const QString &reportPath,
+                       QObject *parent)
+    : QObject(parent), window(window), days(days), reportPath(reportPath),
+      cycles(0) {}
+
+void SoakRunner::start() {
+  startedAt = QDateTime::currentDateTime();
+  elapsed.start();
+  samples.append(takeSample(0));
+
+  // 每个休息阶段都会锁屏，无人值守运行时必须关闭
+  window->setAutoLockEnabled(false);
+  // 无人值守运行，真实的离开检测会把计时器自动暂停
+  if (IdleMonitor *idle = window->findChild<IdleMonitor *>()) {
+    idle->setSource(std::make_unique<FakeIdleSource>());
+  }
+  connect(window, &MainWindow::phaseSwitched, this,
+          &SoakRunner::onPhaseSwitched);
+  window->setTickInterval(1);
+  window->handleCommandLine(QStringList() << qApp->applicationFilePath()
+                                          << "--start");
+}
+
+void SoakRunner::onPhaseSwitched(bool isWorkPhase) {
+  if (!isWorkPhase) {
+    return; // 休息开始，周期还没结束
+  }
+
+  // 每个周期记录一次主题，覆盖历史存储的追加路径
+  cycles++;
+  window->handleCommandLine(QStringList() << qApp->applicationFilePath()
+                                          << "--theme"
+                                          << QString("soak %1").arg(cycles));
+  if (cycles % CyclesPerDay != 0) {
+    return;
+  }
+
+  // 一天结束：切换一次深浅色，覆盖所有登记窗口的主题切换路径
+  const int day = cycles / CyclesPerDay;
+  if (ThemeManager *themes = window->findChild<ThemeManager *>()) {
+    themes->setMode(day % 2 ? ThemeManager::Dark : ThemeManager::Light);
+  }
+  samples.append(takeSample(day));
+
+  if (day >= days) {
+    window->handleCommandLine(QStringList() << qApp->applicationFilePath()
+                                            << "--pause");
+    finish();
+  }
+}
+
+SoakRunner::Sample SoakRunner::takeSample(int day) const {
+  Sample sample;
+  sample.day = day;
+  sample.residentKb = residentKb();
+  sample.liveObjects = countLiveObjects();
+  sample.openFiles = openFileCount();
+  if (FrameRenderer *renderer = window->findChild<FrameRenderer *>()) {
+    sample.cachedFrames = renderer->cachedFrameCount();
+  }
+  for (HeatmapView *heatmap : window->findChildren<HeatmapView *>()) {
+    sample.cachedTiles += heatmap->cachedTileCount();
+  }
+  return sample;
+}
+
+// Qt没有公开的存活对象计数，这里统计应用对象和所有无父窗口的对象树
+qint64 SoakRunner::countLiveObjects() const {
+  QSet<QObject *> objects;
+  objects.insert(qApp);
+  for (QObject *child : qApp->findChildren<QObject *>()) {
+    objects.insert(child);
+  }
+  for (QWidget *widget : QApplication::topLevelWidgets()) {
+    if (widget->parent()) {
+      continue; // 已经包含在父对象的子树中
+    }
+    objects.insert(widget);
+    for (QObject *child : widget->findChildren<QObject *>()) {
+      objects.insert(child);
+    }
+  }
+  return objects.size();
+}
+
+qint64 SoakRunner::residentKb() {
+#if defined(Q_OS_LINUX)
+  QFile statm("/proc/self/statm");
+  if (!statm.open(QIODevice::ReadOnly)) {
+    return -1;
+  }
+  const QList<QByteArray> fields = statm.readAll().split(' ');
+  if (fields.size() < 2) {
+    return -1;
+  }
+  return fields[1].toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+#elif defined(Q_OS_MACOS)
+  mach_task_basic_info info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+    return -1;
+  }
+  return qint64(info.resident_size) / 1024;
+#elif defined(Q_OS_WIN)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return -1;
+  }
+  return qint64(counters.WorkingSetSize) / 1024;
+#else
+  return -1;
+#endif
+}
+
+qint64 SoakRunner::openFileCount() {
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+#if defined(Q_OS_LINUX)
+  const QDir fds("/proc/self/fd");
+#else
+  const QDir fds("/dev/fd");
+#endif
+  if (!fds.exists()) {
+    return -1;
+  }
+  // 列目录本身会占用一个描述符，对比较没有影响
+  return fds.entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot)
+      .size();
+#elif defined(Q_OS_WIN)
+  DWORD handles = 0;
+  if (!GetProcessHandleCount(GetCurrentProcess(), &handles)) {
+    return -1;
+  }
+  return handles;
+#else
+  return -1;
+#endif
+}
+
+// 跳过前四分之一的预热样本，用后四分之一的最小值和中间段的最大值比较：
+// 偶尔的波动不会误报，持续增长则一定会超出允许值
+QJsonObject SoakRunner::analyze(const QString &name, qint64 Sample::*field,
+                                qint64 allowance, bool *passed) const {
+  QJsonObject result;
+  const int n = samples.size();
+  const int quarter = qMax(1, n / 4);
+  if (samples.first().*field < 0 || n < 4) {
+    result["supported"] = samples.first().*field >= 0;
+    result["passed"] = true;
+    return result;
+  }
+
+  qint64 baseline = 0;
+  for (int i = quarter; i < qMax(quarter + 1, n / 2); ++i) {
+    baseline = qMax(baseline, samples[i].*field);
+  }
+  qint64 latest = samples.last().*field;
+  for (int i = n - quarter; i < n; ++i) {
+    latest = qMin(latest, samples[i].*field);
+  }
+
+  const bool ok = latest - baseline <= allowance;
+  result["supported"] = true;
+  result["baseline"] = baseline;
+  result["final"] = latest;
+  result["growth"] = latest - baseline;
+  result["allowance"] = allowance;
+  result["passed"] = ok;
+  if (!ok) {
+    qWarning("浸泡测试: %s 从 %lld 增长到 %lld", qPrintable(name), baseline,
+             latest);
+    *passed = false;
+  }
+  return result;
+}
+
+void SoakRunner::finish() {
+  bool passed = true;
+  QJsonObject metrics;
+  metrics["residentKb"] =
+      analyze("residentKb", &Sample::residentKb, 4096, &passed);
+  metrics["liveObjects"] =
+      analyze("liveObjects", &Sample::liveObjects, 32, &passed);
+  metrics["openFiles"] = analyze("openFiles", &Sample::openFiles, 4, &passed);
+  metrics["cachedFrames"] =
+      analyze("cachedFrames", &Sample::cachedFrames, 0, &passed);
+  metrics["cachedTiles"] =
+      analyze("cachedTiles", &Sample::cachedTiles, 0, &passed);
+
+  QJsonArray sampleArray;
+  for (const Sample &sample : samples) {
+    QJsonObject object;
+    object["day"] = sample.day;
+    object["residentKb"] = sample.residentKb;
+    object["liveObjects"] = sample.liveObjects;
+    object["openFiles"] = sample.openFiles;
+    object["cachedFrames"] = sample.cachedFrames;
+    object["cachedTiles"] = sample.cachedTiles;
+    sampleArray.append(object);
+  }
+
+  QJsonObject report;
+  report["format"] = ReportFormat;
+  report["appVersion"] = QCoreApplication::applicationVersion();
+  report["qtVersion"] = QString(qVersion());
+  report["platform"] = QSysInfo::prettyProductName();
+  report["startedAt"] = startedAt.toString(Qt::ISODate);
+  report["wallSeconds"] = elapsed.elapsed() / 1000.0;
+  report["days"] = days;
+  report["cycles"] = cycles;
+  report["passed"] = passed;
+  report["metrics"] = metrics;
+  // QPixmapCache没有公开占用大小的接口，全局图像缓存不在采样范围内
+  report["notSampled"] = QJsonArray() << "pixmapCache";
+  report["samples"] = sampleArray;
+
+  QFile file(reportPath);
+  if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    file.write(QJsonDocument(report).toJson(QJsonDocument::Indented));
+  } else {
+    qWarning("浸泡测试: 无法写入报告 %s", qPrintable(reportPath));
+    passed = false;
+  }
+
+  qInfo("浸泡测试%s: %d 天, %d 个周期, 用时 %.1f 秒, 报告 %s",
+        passed ? "通过" : "失败", days, cycles, elapsed.elapsed() / 1000.0,
+        qPrintable(reportPath));
+  emit finished(passed ? 0 : 1);
+}
@@ -0,0 +1,59 @@
+#ifndef SOAK_RUNNER_H
+#define SOAK_RUNNER_H
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+
+class MainWindow;
+
+// 浸泡测试：把计时器加速到每毫秒走一秒，连续运行若干天的番茄钟周期，
+// 每个模拟日采样一次内存、对象数、文件描述符以及帧缓存和热力图图块的数量
+// （QPixmapCache的大小无法获取，不在采样范围内）。
+// 任何指标在预热之后持续增长都视为失败，报告写成JSON便于跨版本比较
+class SoakRunner : public QObject {
+  Q_OBJECT
+
+public:
+  SoakRunner(MainWindow *window, int days, const QString &reportPath,
+             QObject *parent = nullptr);
+
+  void start();
+
+signals:
+  void finished(int exitCode); // 0表示通过
+
+private slots:
+  void onPhaseSwitched(bool isWorkPhase);
+
+private:
+  struct Sample {
+    int day = 0;
+    qint64 residentKb = -1; // 不支持的平台为-1
+    qint64 liveObjects = 0;
+    qint64 openFiles = -1;
+    qint64 cachedFrames = 0;
+    qint64 cachedTiles = 0;
+  };
+
+  Sample takeSample(int day) const;
+  qint64 countLiveObjects() const;
+  static qint64 residentKb();
+  static qint64 openFileCount();
+
+  void finish();
+  QJsonObject analyze(const QString &name, qint64 Sample::*field,
+                      qint64 allowance, bool *passed) const;
+
+  MainWindow *window;
+  int days;
+  QString reportPath;
+  int cycles;
+  QList<Sample> samples;
+  QDateTime startedAt;
+  QElapsedTimer elapsed;
+};
+
+#endif // SOAK_RUNNER_H
@@ -0,0 +1,321 @@
+#include "state_file.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileDevice>
+#include <QFileInfo>
+#include <QSet>
+#include <QStandardPaths>
+#include <array>
+
+namespace {
+
+const quint32 Magic = 0x504d5354; // "PMST"
+const quint16 Version = 1;
+const int HeaderSize = 16;
+const int EntrySize = 16;
+const int MaxSections = 64;
+
+quint32 readU32(const char *p) {
+  const uchar *u = reinterpret_cast<const uchar *>(p);
+  return (quint32(u[0]) << 24) | (quint32(u[1]) << 16) |
+         (quint32(u[2]) << 8) | quint32(u[3]);
+}
+
+quint16 readU16(const char *p) {
+  const uchar *u = reinterpret_cast<const uchar *>(p);
+  return quint16((u[0] << 8) | u[1]);
+}
+
+void appendU32(QByteArray &out, quint32 value) {
+  out.append(char(value >> 24));
+  out.append(char(value >> 16));
+  out.append(char(value >> 8));
+  out.append(char(value));
+}
+
+void appendU16(QByteArray &out, quint16 value) {
+  out.append(char(value >> 8));
+  out.append(char(value));
+}
+
+// 旧版QSettings中的键在状态文件中的位置
+QString migratedKey(const QString &key) {
+  if (key == "completedCycles") {
+    return "Timer/completedCycles";
+  }
+  return key;
+}
+
+QString &isolatedDirectory() {
+  static QString dir;
+  return dir;
+}
+
+// 本进程中确认完好的状态文件（加载时校验通过或由本进程写入），
+// 以及已经刷新过备份的文件。QSettings在全局锁内调用读写函数
+struct BackupState {
+  QSet<QString> intact;
+  QSet<QString> refreshed;
+};
+
+BackupState &backupState() {
+  static BackupState state;
+  return state;
+}
+
+} // namespace
+
+QString StateFile::directory() {
+  if (isIsolated()) {
+    return isolatedDirectory();
+  }
+  return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+}
+
+void StateFile::setDirectory(const QString &dir) { isolatedDirectory() = dir; }
+
+bool StateFile::isIsolated() { return !isolatedDirectory().isEmpty(); }
+
+QString StateFile::path() { return directory() + "/state.dat"; }
+
+QSettings::Format StateFile::format() {
+  static const QSettings::Format registered =
+      QSettings::registerFormat("dat", read, write);
+  return registered;
+}
+
+quint32 StateFile::crc32(const QByteArray &data) {
+  static const auto table = [] {
+    std::array<quint32, 256> t{};
+    for (quint32 i = 0; i < 256; ++i) {
+      quint32 c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      }
+      t[i] = c;
+    }
+    return t;
+  }();
+
+  quint32 crc = 0xffffffffu;
+  for (char byte : data) {
+    crc = table[(crc ^ uchar(byte)) & 0xff] ^ (crc >> 8);
+  }
+  return crc ^ 0xffffffffu;
+}
+
+StateFile::Section StateFile::sectionOf(const QString &key) {
+  if (key.startsWith("FloatingTimer/")) {
+    return WindowGeometry;
+  }
+  if (key.startsWith("Timer/")) {
+    return TimerState;
+  }
+  if (key.startsWith("History/")) {
+    return HistoryIndex;
+  }
+  return Settings;
+}
+
+QByteArray StateFile::serialize(const QSettings::SettingsMap &map) {
+  QMap<quint32, QSettings::SettingsMap> sections;
+  for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+    sections[sectionOf(it.key())].insert(it.key(), it.value());
+  }
+
+  QList<QByteArray> payloads;
+  for (const QSettings::SettingsMap &section : sections) {
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << section;
+    payloads.append(payload);
+  }
+
+  QByteArray header;
+  appendU32(header, Magic);
+  appendU16(header, Version);
+  appendU16(header, quint16(sections.size()));
+  appendU32(header, 0); // 保留
+
+  QByteArray table;
+  quint32 offset = HeaderSize + EntrySize * sections.size();
+  int i = 0;
+  for (auto it = sections.constBegin(); it != sections.constEnd(); ++it, ++i) {
+    appendU32(table, it.key());
+    appendU32(table, offset);
+    appendU32(table, quint32(payloads[i].size()));
+    appendU32(table, crc32(payloads[i]));
+    offset += payloads[i].size();
+  }
+
+  // 文件头的CRC同时覆盖分区表
+  QByteArray data = header;
+  appendU32(data, crc32(header + table));
+  data.append(table);
+  for (const QByteArray &payload : payloads) {
+    data.append(payload);
+  }
+  return data;
+}
+
+bool StateFile::parse(const QByteArray &data, QSettings::SettingsMap *map,
+                      QList<quint32> *corrupt) {
+  if (data.size() < HeaderSize || readU32(data.constData()) != Magic) {
+    return false;
+  }
+  const quint16 version = readU16(data.constData() + 4);
+  const int count = readU16(data.constData() + 6);
+  const qint64 tableEnd = HeaderSize + qint64(EntrySize) * count;
+  if (version == 0 || version > Version || count > MaxSections ||
+      data.size() < tableEnd) {
+    return false;
+  }
+  QByteArray covered = data.left(HeaderSize - 4);
+  covered.append(data.constData() + HeaderSize, EntrySize * count);
+  if (crc32(covered) != readU32(data.constData() + HeaderSize - 4)) {
+    return false;
+  }
+
+  for (int i = 0; i < count; ++i) {
+    const char *entry = data.constData() + HeaderSize + EntrySize * i;
+    const quint32 id = readU32(entry);
+    const quint32 offset = readU32(entry + 4);
+    const quint32 size = readU32(entry + 8);
+    if (offset < tableEnd || qint64(offset) + size > data.size()) {
+      corrupt->append(id);
+      continue;
+    }
+
+    // 不复制分区数据，直接在（映射的）文件内容上校验和解析
+    const QByteArray payload =
+        QByteArray::fromRawData(data.constData() + offset, int(size));
+    if (crc32(payload) != readU32(entry + 12)) {
+      corrupt->append(id);
+      continue;
+    }
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_6_0);
+    QSettings::SettingsMap section;
+    in >> section;
+    if (in.status() != QDataStream::Ok) {
+      corrupt->append(id);
+      continue;
+    }
+    for (auto it = section.constBegin(); it != section.constEnd(); ++it) {
+      map->insert(it.key(), it.value());
+    }
+  }
+  return true;
+}
+
+bool StateFile::parseFile(const QString &fileName, QSettings::SettingsMap *map,
+                          QList<quint32> *corrupt) {
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  return parse(file.readAll(), map, corrupt);
+}
+
+bool StateFile::read(QIODevice &device, QSettings::SettingsMap &map) {
+  // 整个文件一次映射到内存，映射不可用时一次读入
+  QFile *file = qobject_cast<QFile *>(&device);
+  const qint64 size = file ? file->size() : 0;
+  uchar *mapped = size > 0 ? file->map(0, size) : nullptr;
+  const QByteArray data =
+      mapped ? QByteArray::fromRawData(reinterpret_cast<const char *>(mapped),
+                                       int(size))
+             : device.readAll();
+  if (data.isEmpty()) {
+    return true;
+  }
+
+  QList<quint32> corrupt;
+  const bool headerOk = parse(data, &map, &corrupt);
+  if (mapped) {
+    file->unmap(mapped);
+  }
+  if (headerOk && corrupt.isEmpty()) {
+    if (file) {
+      backupState().intact.insert(file->fileName());
+    }
+    return true;
+  }
+
+  // 损坏时保留一份现场，再从备份中补回受影响的分区
+  const QString fileName = file ? file->fileName() : path();
+  qWarning("StateFile: %s 已损坏 (%s)，尝试从备份恢复",
+           qPrintable(fileName),
+           headerOk ? qPrintable(QString("%1 个分区").arg(corrupt.size()))
+                    : "文件头");
+  QFile::remove(fileName + ".corrupt");
+  QFile::copy(fileName, fileName + ".corrupt");
+
+  QSettings::SettingsMap backup;
+  QList<quint32> backupCorrupt;
+  if (parseFile(fileName + ".bak", &backup, &backupCorrupt)) {
+    for (auto it = backup.constBegin(); it != backup.constEnd(); ++it) {
+      const quint32 section = sectionOf(it.key());
+      if ((!headerOk || corrupt.contains(section)) &&
+          !backupCorrupt.contains(section)) {
+        map.insert(it.key(), it.value());
+      }
+    }
+  } else {
+    qWarning("StateFile: 没有可用的备份，损坏的部分恢复为默认值");
+  }
+
+  // 总是返回成功：QSettings在格式错误时不再写回，损坏的文件会一直留着
+  return true;
+}
+
+bool StateFile::write(QIODevice &device, const QSettings::SettingsMap &map) {
+  // 每个进程第一次覆盖完好的旧文件之前把它留作备份，下次损坏时用它恢复。
+  // 之后的写入不再刷新，备份保留本次启动前的状态，也不必每次重新解析旧文件
+  QFileDevice *file = qobject_cast<QFileDevice *>(&device);
+  const QString fileName = file ? file->fileName() : QString();
+  BackupState &state = backupState();
+  if (file && state.intact.contains(fileName) &&
+      !state.refreshed.contains(fileName)) {
+    QFile::remove(fileName + ".bak");
+    if (QFile::copy(fileName, fileName + ".bak")) {
+      state.refreshed.insert(fileName);
+    }
+  }
+
+  const QByteArray data = serialize(map);
+  const bool ok = device.write(data) == data.size();
+  if (ok && file) {
+    state.intact.insert(fileName);
+  }
+  return ok;
+}
+
+void StateFile::migrateLegacyStores() {
+  if (isIsolated() || QFile::exists(path())) {
+    return;
+  }
+  QDir().mkpath(QFileInfo(path()).absolutePath());
+
+  QSettings state(path(), format());
+  QSettings legacy("PomodoroApp", "QtPomodoro");
+  foreach (const QString &key, legacy.allKeys()) {
+    // 钩子由用户手工编辑，继续留在原来的文本设置中
+    if (!key.startsWith("Hooks/")) {
+      state.setValue(migratedKey(key), legacy.value(key));
+    }
+  }
+  QSettings floating("QtPomodoro", "FloatingTimer");
+  foreach (const QString &key, floating.allKeys()) {
+    state.setValue("FloatingTimer/" + key, floating.value(key));
+  }
+
+  // 旧的存储保持不动，降级到旧版本时仍然可用
+  state.sync();
+  if (state.status() == QSettings::NoError) {
+    qInfo("StateFile: 已从旧的设置迁移 %lld 项到 %s",
+          qint64(state.allKeys().size()), qPrintable(path()));
+  }
+}
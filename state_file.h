@@ -0,0 +1,59 @@
+#ifndef STATE_FILE_H
+#define STATE_FILE_H
+
+#include <QByteArray>
+#include <QSettings>
+#include <QString>
+
+// 应用状态文件：QSettings的自定义二进制格式，所有持久状态集中在一个文件中。
+//
+// 布局（大端序）：
+//   文件头   magic(4) version(2) sectionCount(2) reserved(4) headerCrc(4)
+//   分区表   每个分区 id(4) offset(4) size(4) crc(4)
+//   分区数据 每个分区是QDataStream序列化的键值表
+//
+// 键按顶层分组划分到分区：FloatingTimer/为窗口位置，Timer/为计时状态，
+// History/为历史存档索引，其余为设置。加载时一次映射（或读取）整个文件，
+// 逐个分区校验CRC32；损坏的分区从备份（每个进程第一次写入前完好的文件）
+// 恢复，备份也不可用时丢弃该分区使用默认值，不影响其他分区。
+//
+// 例外：钩子配置（Hooks分组）由用户用文本编辑器维护，二进制文件无法手工编辑，
+// 因此继续保存在系统原生的设置中，不迁移到状态文件（见HookRunner::loadConfig）
+class StateFile {
+public:
+  enum Section : quint32 {
+    Settings = 1,
+    WindowGeometry = 2,
+    TimerState = 3,
+    HistoryIndex = 4,
+  };
+
+  // 数据目录，状态文件、历史存档和统计汇总都保存在这里，默认为应用数据目录
+  static QString directory();
+  // 使用独立的数据目录（浸泡测试用）：之后不再读取、迁移任何系统原生设置，
+  // 钩子也不会加载。需要在创建任何存储对象之前调用
+  static void setDirectory(const QString &dir);
+  static bool isIsolated();
+
+  static QString path();
+  static QSettings::Format format();
+
+  // 状态文件不存在时，从旧的QSettings存储迁移设置和浮动窗口位置。
+  // 使用独立目录时不迁移
+  static void migrateLegacyStores();
+
+  static Section sectionOf(const QString &key);
+  static quint32 crc32(const QByteArray &data);
+
+private:
+  static bool read(QIODevice &device, QSettings::SettingsMap &map);
+  static bool write(QIODevice &device, const QSettings::SettingsMap &map);
+  static QByteArray serialize(const QSettings::SettingsMap &map);
+  // 解析整个文件，返回校验失败的分区；文件头损坏时返回false
+  static bool parse(const QByteArray &data, QSettings::SettingsMap *map,
+                    QList<quint32> *corrupt);
+  static bool parseFile(const QString &fileName, QSettings::SettingsMap *map,
+                        QList<quint32> *corrupt);
+};
+
+#endif // STATE_FILE_H
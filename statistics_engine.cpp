@@ -0,0 +1,414 @@
+#include "statistics_engine.h"
+#include "state_file.h"
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+namespace {
+
+const quint32 RollupMagic = 0x504f4d52; // "POMR"
+const quint32 RollupVersion = 3; // 版本不一致时从原始历史重建
+const int RebuildChunkSize = 4096; // 并行重建时每个任务处理的记录数
+
+QByteArray toJsonLine(const IntervalRecord &record) {
+  QJsonObject object;
+  object["s"] = record.start.toString(Qt::ISODateWithMs);
+  object["e"] = record.end.toString(Qt::ISODateWithMs);
+  object["p"] = record.plannedSeconds;
+  object["a"] = record.actualSeconds;
+  object["i"] = record.interruptions;
+  object["w"] = record.isWork;
+  object["t"] = record.theme;
+  if (!record.away.isEmpty()) {
+    QJsonArray away;
+    for (const AwaySpan &span : record.away) {
+      away.append(QJsonArray() << span.since.toString(Qt::ISODateWithMs)
+                               << span.until.toString(Qt::ISODateWithMs));
+    }
+    object["x"] = away;
+  }
+  return QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+}
+
+bool fromJsonLine(const QByteArray &line, IntervalRecord *record) {
+  const QJsonObject object = QJsonDocument::fromJson(line).object();
+  if (object.isEmpty()) {
+    return false;
+  }
+  record->start = QDateTime::fromString(object["s"].toString(),
+                                        Qt::ISODateWithMs);
+  record->end = QDateTime::fromString(object["e"].toString(),
+                                      Qt::ISODateWithMs);
+  record->plannedSeconds = object["p"].toInt();
+  record->actualSeconds = object["a"].toInt();
+  record->interruptions = object["i"].toInt();
+  record->isWork = object["w"].toBool();
+  record->theme = object["t"].toString();
+  record->away.clear();
+  for (const QJsonValue &value : object["x"].toArray()) {
+    const QJsonArray span = value.toArray();
+    record->away.append(
+        {QDateTime::fromString(span.at(0).toString(), Qt::ISODateWithMs),
+         QDateTime::fromString(span.at(1).toString(), Qt::ISODateWithMs)});
+  }
+  return record->start.isValid();
+}
+
+Rollups rollupChunk(const QList<QByteArray> &lines) {
+  Rollups result;
+  IntervalRecord record;
+  for (const QByteArray &line : lines) {
+    if (fromJsonLine(line, &record)) {
+      result.add(record);
+    }
+  }
+  return result;
+}
+
+void mergeRollups(Rollups &result, const Rollups &part) { result.merge(part); }
+
+} // namespace
+
+// 汇总桶的序列化，需位于全局命名空间以便QMap/QHash的流操作找到
+static QDataStream &operator<<(QDataStream &out, const RollupBucket &bucket) {
+  return out << bucket.focusSeconds << bucket.breakSeconds
+             << bucket.plannedSeconds << qint32(bucket.workCount)
+             << qint32(bucket.breakCount) << qint32(bucket.interruptions);
+}
+
+static QDataStream &operator>>(QDataStream &in, RollupBucket &bucket) {
+  qint32 workCount, breakCount, interruptions;
+  in >> bucket.focusSeconds >> bucket.breakSeconds >> bucket.plannedSeconds >>
+      workCount >> breakCount >> interruptions;
+  bucket.workCount = workCount;
+  bucket.breakCount = breakCount;
+  bucket.interruptions = interruptions;
+  return in;
+}
+
+void RollupBucket::add(const IntervalRecord &record, bool counted) {
+  if (record.isWork) {
+    focusSeconds += record.actualSeconds;
+  } else {
+    breakSeconds += record.actualSeconds;
+  }
+  if (!counted) {
+    return;
+  }
+  if (record.isWork) {
+    workCount++;
+  } else {
+    breakCount++;
+  }
+  plannedSeconds += record.plannedSeconds;
+  interruptions += record.interruptions;
+}
+
+void RollupBucket::merge(const RollupBucket &other) {
+  focusSeconds += other.focusSeconds;
+  breakSeconds += other.breakSeconds;
+  plannedSeconds += other.plannedSeconds;
+  workCount += other.workCount;
+  breakCount += other.breakCount;
+  interruptions += other.interruptions;
+}
+
+void Rollups::add(const IntervalRecord &record) {
+  // 旧版本记录的实际时间是包含暂停的墙上时间，不超过计划时长
+  const int credited = qBound(0, record.actualSeconds, record.plannedSeconds);
+  if (record.isWork) {
+    IntervalRecord whole = record;
+    whole.actualSeconds = credited;
+    themes[record.theme].add(whole);
+  }
+
+  const QDateTime end =
+      record.end.isValid() && record.end > record.start ? record.end
+                                                        : record.start;
+  const qint64 span = record.start.secsTo(end);
+  QDateTime partStart = record.start;
+  int remaining = credited;
+  bool first = true;
+  while (true) {
+    const QDate date = partStart.date();
+    const QDateTime midnight = date.addDays(1).startOfDay();
+    const bool last = midnight >= end;
+
+    // 按这一天占整个时段的比例分配实际时间，最后一段取余数
+    IntervalRecord part = record;
+    part.start = partStart;
+    part.end = last ? end : midnight;
+    part.actualSeconds =
+        last ? remaining
+             : int(qint64(credited) * partStart.secsTo(part.end) / span);
+    remaining -= part.actualSeconds;
+
+    daily[date].add(part, first);
+    weekly[StatisticsEngine::weekStart(date)].add(part, first);
+    if (record.isWork) {
+      dailyThemes[date][record.theme].add(part, first);
+    }
+    if (last) {
+      break;
+    }
+    partStart = midnight;
+    first = false;
+  }
+  recordCount++;
+}
+
+void Rollups::merge(const Rollups &other) {
+  for (auto it = other.daily.cbegin(); it != other.daily.cend(); ++it) {
+    daily[it.key()].merge(it.value());
+  }
+  for (auto it = other.weekly.cbegin(); it != other.weekly.cend(); ++it) {
+    weekly[it.key()].merge(it.value());
+  }
+  for (auto it = other.themes.cbegin(); it != other.themes.cend(); ++it) {
+    themes[it.key()].merge(it.value());
+  }
+  for (auto it = other.dailyThemes.cbegin(); it != other.dailyThemes.cend();
+       ++it) {
+    QHash<QString, RollupBucket> &dayThemes = dailyThemes[it.key()];
+    for (auto theme = it.value().cbegin(); theme != it.value().cend();
+         ++theme) {
+      dayThemes[theme.key()].merge(theme.value());
+    }
+  }
+  recordCount += other.recordCount;
+}
+
+StatisticsEngine::StatisticsEngine(const QString &dir, OpenMode mode,
+                                   QObject *parent)
+    : QObject(parent), dataDir(dir), readOnly(mode == ReadOnly),
+      rawHistoryBytes(0), rebuildWatcher(nullptr) {
+  if (dataDir.isEmpty()) {
+    dataDir = StateFile::directory();
+  }
+  if (!readOnly) {
+    QDir().mkpath(dataDir);
+  }
+
+  // 汇总文件缺失或与原始历史不一致时重新计算
+  if (loadRollups()) {
+    return;
+  }
+  if (mode == BackgroundRebuild) {
+    startBackgroundRebuild();
+  } else if (mode == BlockingRebuild || mode == ReadOnly) {
+    rebuild();
+  }
+}
+
+QString StatisticsEngine::rawHistoryPath() const {
+  return dataDir + "/intervals.jsonl";
+}
+
+QString StatisticsEngine::rollupPath() const {
+  return dataDir + "/rollups.dat";
+}
+
+QDate StatisticsEngine::weekStart(const QDate &date) {
+  return date.addDays(1 - date.dayOfWeek());
+}
+
+QString StatisticsEngine::sourceKey() const {
+  const QFileInfo info(rawHistoryPath());
+  if (!info.exists()) {
+    return QString("%1:0").arg(RollupVersion);
+  }
+  return QString("%1:%2:%3")
+      .arg(RollupVersion)
+      .arg(info.size())
+      .arg(info.lastModified().toMSecsSinceEpoch());
+}
+
+void StatisticsEngine::recordInterval(const IntervalRecord &record) {
+  if (readOnly) {
+    qWarning("StatisticsEngine: %s 以只读方式打开，无法记录时段",
+             qPrintable(dataDir));
+    return;
+  }
+
+  // 先追加原始历史，再增量更新汇总
+  QFile file(rawHistoryPath());
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    qWarning("StatisticsEngine: 无法写入时段历史 %s",
+             qPrintable(rawHistoryPath()));
+    return;
+  }
+  file.write(toJsonLine(record));
+  const qint64 size = file.size();
+  file.close();
+
+  // 后台重建只汇总开始时已有的记录，新记录等重建完成后再加入
+  if (rebuildWatcher) {
+    pendingRecords.append(record);
+  } else {
+    rawHistoryBytes = size;
+    rollups.add(record);
+    saveRollups();
+  }
+
+  emit intervalRecorded(record);
+}
+
+RollupBucket StatisticsEngine::day(const QDate &date) const {
+  return rollups.daily.value(date);
+}
+
+QMap<QDate, RollupBucket> StatisticsEngine::dailyRange(const QDate &from,
+                                                       const QDate &to) const {
+  QMap<QDate, RollupBucket> result;
+  for (auto it = rollups.daily.lowerBound(from);
+       it != rollups.daily.cend() && it.key() <= to; ++it) {
+    result.insert(it.key(), it.value());
+  }
+  return result;
+}
+
+QMap<QDate, RollupBucket>
+StatisticsEngine::weeklyRange(const QDate &from, const QDate &to) const {
+  QMap<QDate, RollupBucket> result;
+  for (auto it = rollups.weekly.lowerBound(weekStart(from));
+       it != rollups.weekly.cend() && it.key() <= to; ++it) {
+    result.insert(it.key(), it.value());
+  }
+  return result;
+}
+
+QHash<QString, RollupBucket>
+StatisticsEngine::themeRange(const QDate &from, const QDate &to) const {
+  QHash<QString, RollupBucket> result;
+  for (auto it = rollups.dailyThemes.lowerBound(from);
+       it != rollups.dailyThemes.cend() && it.key() <= to; ++it) {
+    for (auto theme = it.value().cbegin(); theme != it.value().cend();
+         ++theme) {
+      result[theme.key()].merge(theme.value());
+    }
+  }
+  return result;
+}
+
+Rollups StatisticsEngine::computeRollups(const QString &path, qint64 bytes) {
+  QFile file(path);
+  if (bytes <= 0 || !file.open(QIODevice::ReadOnly)) {
+    return Rollups();
+  }
+  const QByteArray data = file.read(bytes);
+  file.close();
+
+  // 按块拆分后并行汇总，最后合并各块的结果
+  const QList<QByteArray> lines = data.split('\n');
+  QList<QList<QByteArray>> chunks;
+  for (qsizetype i = 0; i < lines.size(); i += RebuildChunkSize) {
+    chunks.append(lines.mid(i, RebuildChunkSize));
+  }
+  return QtConcurrent::blockingMappedReduced<Rollups>(
+      chunks, rollupChunk, mergeRollups, QtConcurrent::UnorderedReduce);
+}
+
+bool StatisticsEngine::rebuild() {
+  if (rebuildWatcher) {
+    return true; // 后台重建完成后会发出rollupsRebuilt
+  }
+  QElapsedTimer elapsed;
+  elapsed.start();
+
+  const QFileInfo info(rawHistoryPath());
+  if (info.exists() && !info.isReadable()) {
+    return false;
+  }
+  rawHistoryBytes = info.exists() ? info.size() : 0;
+  rollups = computeRollups(rawHistoryPath(), rawHistoryBytes);
+
+  saveRollups();
+  qInfo("StatisticsEngine: 已从 %lld 条记录重建统计 (%lld ms)",
+        rollups.recordCount, elapsed.elapsed());
+  emit rollupsRebuilt();
+  return true;
+}
+
+void StatisticsEngine::startBackgroundRebuild() {
+  // 与历史压缩一样在线程池中计算，完成后回到GUI线程发布结果
+  const qint64 bytes = QFileInfo(rawHistoryPath()).size();
+  rebuildWatcher = new QFutureWatcher<Rollups>(this);
+  connect(rebuildWatcher, &QFutureWatcher<Rollups>::finished, this,
+          &StatisticsEngine::finishBackgroundRebuild);
+  rebuildWatcher->setFuture(
+      QtConcurrent::run(&StatisticsEngine::computeRollups, rawHistoryPath(),
+                        bytes));
+}
+
+void StatisticsEngine::finishBackgroundRebuild() {
+  if (!rebuildWatcher) {
+    return;
+  }
+  QFutureWatcher<Rollups> *watcher = rebuildWatcher;
+  rebuildWatcher = nullptr;
+  rollups = watcher->result();
+  watcher->deleteLater();
+
+  // 重建期间记录的时段已经写入原始历史，补进汇总
+  for (const IntervalRecord &record : pendingRecords) {
+    rollups.add(record);
+  }
+  pendingRecords.clear();
+  rawHistoryBytes = QFileInfo(rawHistoryPath()).size();
+
+  saveRollups();
+  qInfo("StatisticsEngine: 后台重建完成，共 %lld 条记录", rollups.recordCount);
+  emit rollupsRebuilt();
+}
+
+bool StatisticsEngine::loadRollups() {
+  QFile file(rollupPath());
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_6_0);
+  quint32 magic, version;
+  qint64 rawBytes;
+  in >> magic >> version >> rawBytes;
+  if (magic != RollupMagic || version != RollupVersion ||
+      rawBytes != QFileInfo(rawHistoryPath()).size()) {
+    return false;
+  }
+
+  Rollups loaded;
+  in >> loaded.recordCount >> loaded.daily >> loaded.weekly >> loaded.themes >>
+      loaded.dailyThemes;
+  if (in.status() != QDataStream::Ok) {
+    return false;
+  }
+
+  rollups = loaded;
+  rawHistoryBytes = rawBytes;
+  return true;
+}
+
+void StatisticsEngine::saveRollups() {
+  if (readOnly) {
+    return;
+  }
+  QSaveFile file(rollupPath());
+  if (!file.open(QIODevice::WriteOnly)) {
+    return;
+  }
+
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_6_0);
+  out << RollupMagic << RollupVersion << rawHistoryBytes;
+  out << rollups.recordCount << rollups.daily << rollups.weekly
+      << rollups.themes << rollups.dailyThemes;
+  file.commit();
+}
@@ -0,0 +1,126 @@
+#ifndef STATISTICS_ENGINE_H
+#define STATISTICS_ENGINE_H
+
+#include <QDate>
+#include <QDateTime>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QString>
+
+// 检测到的一段离开，期间计时器自动暂停
+struct AwaySpan {
+  QDateTime since;
+  QDateTime until;
+};
+
+// 一次完整的工作或休息时段
+struct IntervalRecord {
+  QDateTime start;
+  QDateTime end;
+  int plannedSeconds = 0; // 计划时长
+  int actualSeconds = 0;  // 实际计时的时间（不含暂停和离开）
+  int interruptions = 0;  // 中断（暂停）次数，包括离开
+  bool isWork = true;
+  QString theme;        // 工作主题，可以为空
+  QList<AwaySpan> away; // 时段内的离开，不计入实际时间
+};
+
+// 统计桶：按天、按周或按主题汇总的数据
+struct RollupBucket {
+  qint64 focusSeconds = 0;
+  qint64 breakSeconds = 0;
+  qint64 plannedSeconds = 0;
+  int workCount = 0;
+  int breakCount = 0;
+  int interruptions = 0;
+
+  // 时长按实际计时累加；次数、计划时长和中断只在counted为true时计入，
+  // 跨天的时段拆分后只有第一段计数
+  void add(const IntervalRecord &record, bool counted = true);
+  void merge(const RollupBucket &other);
+};
+
+// 全部汇总数据，时段关闭时增量更新。跨越午夜的时段按墙上时间的比例
+// 拆分到各天和各周
+struct Rollups {
+  QMap<QDate, RollupBucket> daily;
+  QMap<QDate, RollupBucket> weekly; // 以每周一为键
+  QHash<QString, RollupBucket> themes;
+  QMap<QDate, QHash<QString, RollupBucket>> dailyThemes; // 按天的主题分布
+  qint64 recordCount = 0;
+
+  void add(const IntervalRecord &record);
+  void merge(const Rollups &other);
+};
+
+// 统计引擎：记录所有时段的原始历史，并维护按天/周/主题的汇总，
+// 查询只需遍历汇总桶，与历史记录条数无关
+class StatisticsEngine : public QObject {
+  Q_OBJECT
+
+public:
+  // 汇总缺失或过期时的处理方式
+  enum OpenMode {
+    BackgroundRebuild, // 在工作线程中重建，完成后发出rollupsRebuilt（界面使用）
+    BlockingRebuild,   // 在构造函数中同步重建
+    NoRebuild,         // 只加载，由调用者决定是否调用rebuild()
+    ReadOnly,          // 不写任何文件，需要时在内存中同步重建（报告用）
+  };
+
+  // dataDir为空时使用应用数据目录
+  explicit StatisticsEngine(const QString &dataDir = QString(),
+                            OpenMode mode = BlockingRebuild,
+                            QObject *parent = nullptr);
+
+  void recordInterval(const IntervalRecord &record);
+
+  RollupBucket day(const QDate &date) const;
+  QMap<QDate, RollupBucket> dailyRange(const QDate &from,
+                                       const QDate &to) const;
+  QMap<QDate, RollupBucket> weeklyRange(const QDate &from,
+                                        const QDate &to) const;
+  const QHash<QString, RollupBucket> &themeTotals() const {
+    return rollups.themes;
+  }
+  QHash<QString, RollupBucket> themeRange(const QDate &from,
+                                          const QDate &to) const;
+  qint64 recordCount() const { return rollups.recordCount; }
+  QDate firstRecordedDay() const {
+    return rollups.daily.isEmpty() ? QDate() : rollups.daily.firstKey();
+  }
+
+  // 原始历史的标识（大小和修改时间），标识不变时汇总也不会变化
+  QString sourceKey() const;
+
+  // 从原始历史并行重新计算所有汇总
+  bool rebuild();
+  bool isRebuilding() const { return rebuildWatcher != nullptr; }
+
+  static QDate weekStart(const QDate &date);
+
+signals:
+  void intervalRecorded(const IntervalRecord &record);
+  void rollupsRebuilt();
+
+private:
+  QString rawHistoryPath() const;
+  QString rollupPath() const;
+  bool loadRollups();
+  void saveRollups();
+  void startBackgroundRebuild();
+  void finishBackgroundRebuild();
+  // 汇总原始历史文件的前bytes字节，可在任意线程调用
+  static Rollups computeRollups(const QString &path, qint64 bytes);
+
+  QString dataDir;
+  bool readOnly;
+  Rollups rollups;
+  qint64 rawHistoryBytes; // 汇总对应的原始历史文件大小，用于校验
+  QFutureWatcher<Rollups> *rebuildWatcher; // 后台重建进行中时不为空
+  QList<IntervalRecord> pendingRecords;    // 后台重建期间新记录的时段
+};
+
+#endif // STATISTICS_ENGINE_H
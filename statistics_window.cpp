@@ -0,0 +1,466 @@
+#include "statistics_window.h"
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QMenu>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QSaveFile>
+#include <QToolTip>
+#include <QVBoxLayout>
+#include <algorithm>
+
+namespace {
+
+const int CellSize = 12;   // 每天的格子大小
+const int CellSpacing = 2; // 格子间距
+const int CellStep = CellSize + CellSpacing;
+const int HeaderHeight = 16; // 月份标题高度
+const int TileWidth = 6 * CellStep + 8;
+const int TileHeight = HeaderHeight + 7 * CellStep;
+const int TilesPerRow = 6;
+
+} // namespace
+
+HeatmapView::HeatmapView(StatisticsEngine *engine, QWidget *parent)
+    : QWidget(parent), engine(engine), year(QDate::currentDate().year()),
+      isDarkTheme(false), cachedDpr(1.0), dayChangeTimer(new QTimer(this)) {
+  setMouseTracking(true);
+  setMinimumSize(sizeHint());
+
+  dayChangeTimer->setSingleShot(true);
+  dayChangeTimer->setTimerType(Qt::VeryCoarseTimer);
+  connect(dayChangeTimer, &QTimer::timeout, this, &HeatmapView::onDayChanged);
+  scheduleDayChange();
+}
+
+QSize HeatmapView::sizeHint() const {
+  return QSize(TilesPerRow * TileWidth, 2 * TileHeight);
+}
+
+void HeatmapView::setYear(int newYear) {
+  if (year == newYear) {
+    return;
+  }
+  year = newYear;
+  update();
+}
+
+void HeatmapView::setDarkTheme(bool dark) {
+  if (isDarkTheme == dark) {
+    return;
+  }
+  isDarkTheme = dark;
+  update(); // 图块缓存以主题区分，两种主题的图块可以同时保留
+}
+
+int HeatmapView::tileKey(int tileYear, int month) const {
+  return (tileYear * 100 + month) * 2 + (isDarkTheme ? 1 : 0);
+}
+
+QPoint HeatmapView::tileOrigin(int month) const {
+  const int index = month - 1;
+  return QPoint((index % TilesPerRow) * TileWidth,
+                (index / TilesPerRow) * TileHeight);
+}
+
+QRect HeatmapView::cellRect(const QDate &date) const {
+  // 每列为一周，每行为星期几（周一在最上方）
+  const int offset = QDate(date.year(), date.month(), 1).dayOfWeek() - 1;
+  const int index = date.day() - 1 + offset;
+  return QRect((index / 7) * CellStep, HeaderHeight + (index % 7) * CellStep,
+               CellSize, CellSize);
+}
+
+QDate HeatmapView::dateAt(const QPoint &pos) const {
+  const int column = pos.x() / TileWidth;
+  const int row = pos.y() / TileHeight;
+  if (column >= TilesPerRow || row >= 2) {
+    return QDate();
+  }
+  const int month = row * TilesPerRow + column + 1;
+  const QPoint local = pos - tileOrigin(month);
+  if (local.y() < HeaderHeight) {
+    return QDate();
+  }
+
+  const QDate first(year, month, 1);
+  const int index = (local.x() / CellStep) * 7 +
+                    (local.y() - HeaderHeight) / CellStep -
+                    (first.dayOfWeek() - 1);
+  if (index < 0 || index >= first.daysInMonth()) {
+    return QDate();
+  }
+  return first.addDays(index);
+}
+
+QColor HeatmapView::levelColor(qint64 focusSeconds) const {
+  // 使用固定的分级阈值，新增数据不会改变其他格子的颜色，
+  // 因此只需重绘发生变化的那一天
+  static const QColor light[] = {QColor(235, 237, 240), QColor(255, 205, 190),
+                                 QColor(250, 150, 120), QColor(235, 95, 70),
+                                 QColor(190, 45, 30)};
+  static const QColor dark[] = {QColor(60, 60, 60), QColor(110, 50, 40),
+                                QColor(165, 65, 45), QColor(215, 85, 60),
+                                QColor(255, 120, 90)};
+  const qint64 minutes = focusSeconds / 60;
+  int level = 0;
+  if (minutes >= 150) {
+    level = 4;
+  } else if (minutes >= 100) {
+    level = 3;
+  } else if (minutes >= 50) {
+    level = 2;
+  } else if (minutes > 0) {
+    level = 1;
+  }
+  return isDarkTheme ? dark[level] : light[level];
+}
+
+const QImage &HeatmapView::tile(int month) {
+  const int key = tileKey(year, month);
+  auto it = tiles.find(key);
+  if (it == tiles.end()) {
+    it = tiles.insert(key, renderTile(year, month));
+  }
+  return it.value();
+}
+
+void HeatmapView::paintCell(QPainter &painter, const QDate &date) const {
+  const QRect rect = cellRect(date);
+  painter.setCompositionMode(QPainter::CompositionMode_Source);
+  painter.fillRect(rect.adjusted(-1, -1, 1, 1), Qt::transparent);
+  painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+  painter.setPen(Qt::NoPen);
+  painter.setBrush(levelColor(engine->day(date).focusSeconds));
+  painter.drawRoundedRect(rect, 2, 2);
+}
+
+QImage HeatmapView::renderTile(int tileYear, int month) const {
+  QImage image(QSize(TileWidth, TileHeight) * cachedDpr,
+               QImage::Format_ARGB32_Premultiplied);
+  image.setDevicePixelRatio(cachedDpr);
+  image.fill(Qt::transparent);
+
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::Antialiasing);
+
+  painter.setPen(isDarkTheme ? QColor(220, 220, 220) : QColor(60, 60, 60));
+  painter.drawText(QRect(0, 0, TileWidth, HeaderHeight),
+                   Qt::AlignLeft | Qt::AlignVCenter,
+                   QString("%1月").arg(month));
+
+  // 一次查询整个月的日汇总
+  const QDate first(tileYear, month, 1);
+  const QDate last = first.addDays(first.daysInMonth() - 1);
+  const auto days = engine->dailyRange(first, last);
+  painter.setPen(Qt::NoPen);
+  for (QDate date = first; date <= last; date = date.addDays(1)) {
+    painter.setBrush(levelColor(days.value(date).focusSeconds));
+    painter.drawRoundedRect(cellRect(date), 2, 2);
+  }
+  return image;
+}
+
+void HeatmapView::updateDay(const QDate &date) {
+  if (date.year() != year) {
+    // 其他年份的图块（两种主题）在下次显示时重新渲染
+    const int key = tileKey(date.year(), date.month());
+    tiles.remove(key);
+    tiles.remove(key ^ 1);
+    return;
+  }
+
+  // 只在缓存图块上重绘这一天的格子
+  const int key = tileKey(year, date.month());
+  auto it = tiles.find(key);
+  if (it != tiles.end()) {
+    QPainter painter(&it.value());
+    painter.setRenderHint(QPainter::Antialiasing);
+    paintCell(painter, date);
+  }
+  // 另一主题的图块直接失效
+  tiles.remove(key ^ 1);
+
+  update(cellRect(date)
+             .adjusted(-1, -1, 1, 1)
+             .translated(tileOrigin(date.month())));
+}
+
+void HeatmapView::invalidate() {
+  tiles.clear();
+  update();
+}
+
+void HeatmapView::paintEvent(QPaintEvent *event) {
+  // 设备像素比变化时（例如移动到另一块屏幕）清空缓存
+  if (!qFuzzyCompare(cachedDpr, devicePixelRatioF())) {
+    cachedDpr = devicePixelRatioF();
+    tiles.clear();
+  }
+
+  QPainter painter(this);
+  for (int month = 1; month <= 12; ++month) {
+    const QRect target(tileOrigin(month), QSize(TileWidth, TileHeight));
+    if (event->rect().intersects(target)) {
+      painter.drawImage(target.topLeft(), tile(month));
+    }
+  }
+
+  // 今天的边框画在缓存之外，日期变化后图块仍然有效
+  const QDate today = QDate::currentDate();
+  if (today.year() == year) {
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(isDarkTheme ? Qt::white : Qt::black, 1));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRoundedRect(
+        cellRect(today).translated(tileOrigin(today.month())), 2, 2);
+  }
+}
+
+void HeatmapView::scheduleDayChange() {
+  // 过了午夜把边框移到新的一天
+  const QDateTime now = QDateTime::currentDateTime();
+  const qint64 msecs =
+      now.msecsTo(now.date().addDays(1).startOfDay()) + 1000;
+  dayChangeTimer->start(int(qMin<qint64>(msecs, 24 * 3600 * 1000)));
+}
+
+void HeatmapView::onDayChanged() {
+  update();
+  scheduleDayChange();
+}
+
+void HeatmapView::mouseMoveEvent(QMouseEvent *event) {
+  const QDate date = dateAt(event->position().toPoint());
+  if (!date.isValid()) {
+    QToolTip::hideText();
+    return;
+  }
+
+  const RollupBucket bucket = engine->day(date);
+  QToolTip::showText(event->globalPosition().toPoint(),
+                     QString("%1\n专注 %2 分钟，完成 %3 个番茄钟")
+                         .arg(date.toString("yyyy-MM-dd"))
+                         .arg(bucket.focusSeconds / 60)
+                         .arg(bucket.workCount),
+                     this);
+}
+
+BarChart::BarChart(const QString &title, QWidget *parent)
+    : QWidget(parent), title(title), isDarkTheme(false) {}
+
+QSize BarChart::sizeHint() const { return QSize(320, 220); }
+
+void BarChart::setData(const QList<QPair<QString, double>> &data) {
+  bars = data;
+  update();
+}
+
+void BarChart::setDarkTheme(bool dark) {
+  isDarkTheme = dark;
+  update();
+}
+
+void BarChart::paintEvent(QPaintEvent *event) {
+  Q_UNUSED(event)
+
+  QPainter painter(this);
+  painter.setRenderHint(QPainter::Antialiasing);
+
+  const QColor textColor =
+      isDarkTheme ? QColor(220, 220, 220) : QColor(60, 60, 60);
+  const QColor barColor =
+      isDarkTheme ? QColor(215, 85, 60) : QColor(235, 95, 70);
+
+  painter.setPen(textColor);
+  QFont titleFont = font();
+  titleFont.setBold(true);
+  painter.setFont(titleFont);
+  painter.drawText(QRect(0, 0, width(), 20), Qt::AlignLeft | Qt::AlignVCenter,
+                   title);
+  painter.setFont(font());
+
+  if (bars.isEmpty()) {
+    painter.drawText(rect(), Qt::AlignCenter, "暂无数据");
+    return;
+  }
+
+  double maxValue = 0;
+  for (const auto &bar : bars) {
+    maxValue = std::max(maxValue, bar.second);
+  }
+
+  const int labelWidth = 80;
+  const int valueWidth = 60;
+  const int rowHeight = std::min(24, (height() - 24) / int(bars.size()));
+  const int barArea = width() - labelWidth - valueWidth;
+  int y = 24;
+  for (const auto &bar : bars) {
+    const QRect labelRect(0, y, labelWidth - 6, rowHeight);
+    painter.setPen(textColor);
+    painter.drawText(labelRect, Qt::AlignRight | Qt::AlignVCenter,
+                     painter.fontMetrics().elidedText(bar.first, Qt::ElideRight,
+                                                      labelRect.width()));
+
+    const int barWidth =
+        maxValue > 0 ? static_cast<int>(barArea * bar.second / maxValue) : 0;
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(barColor);
+    painter.drawRoundedRect(QRect(labelWidth, y + 3, barWidth, rowHeight - 6),
+                            3, 3);
+
+    painter.setPen(textColor);
+    painter.drawText(QRect(labelWidth + barWidth + 4, y, valueWidth, rowHeight),
+                     Qt::AlignLeft | Qt::AlignVCenter,
+                     QString("%1分钟").arg(qRound(bar.second)));
+    y += rowHeight;
+  }
+}
+
+StatisticsWindow::StatisticsWindow(StatisticsEngine *engine, QWidget *parent)
+    : QWidget(parent, Qt::Window), engine(engine), isDarkTheme(false) {
+  setWindowTitle("番茄统计");
+
+  yearComboBox = new QComboBox(this);
+  summaryLabel = new QLabel(this);
+  reportButton = new QPushButton("导出报告", this);
+  heatmap = new HeatmapView(engine, this);
+  themeChart = new BarChart("按主题专注时间", this);
+  weekdayChart = new BarChart("按星期专注时间", this);
+
+  QHBoxLayout *headerLayout = new QHBoxLayout;
+  headerLayout->addWidget(yearComboBox);
+  headerLayout->addWidget(summaryLabel, 1);
+  headerLayout->addWidget(reportButton);
+
+  QMenu *reportMenu = new QMenu(reportButton);
+  reportMenu->addAction("本周周报", this,
+                        [this]() { exportReport(ReportGenerator::Weekly); });
+  reportMenu->addAction("本月月报", this,
+                        [this]() { exportReport(ReportGenerator::Monthly); });
+  reportButton->setMenu(reportMenu);
+
+  QHBoxLayout *chartLayout = new QHBoxLayout;
+  chartLayout->addWidget(themeChart);
+  chartLayout->addWidget(weekdayChart);
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addLayout(headerLayout);
+  layout->addWidget(heatmap);
+  layout->addLayout(chartLayout);
+
+  populateYears();
+  updateCharts();
+
+  connect(yearComboBox, &QComboBox::currentIndexChanged, this,
+          &StatisticsWindow::onYearChanged);
+  connect(engine, &StatisticsEngine::intervalRecorded, this,
+          &StatisticsWindow::onIntervalRecorded);
+  connect(engine, &StatisticsEngine::rollupsRebuilt, this,
+          &StatisticsWindow::reload);
+}
+
+void StatisticsWindow::setDarkTheme(bool dark) {
+  isDarkTheme = dark;
+  heatmap->setDarkTheme(dark);
+  themeChart->setDarkTheme(dark);
+  weekdayChart->setDarkTheme(dark);
+}
+
+void StatisticsWindow::exportReport(ReportGenerator::Period period) {
+  const QDate today = QDate::currentDate();
+  const QString defaultFileName = ReportGenerator::fileName(
+      period, ReportGenerator::periodStart(period, today),
+      ReportGenerator::Markdown);
+  QString filePath =
+      QFileDialog::getSaveFileName(this, "导出报告", defaultFileName,
+                                   "Markdown文件 (*.md);;HTML文件 (*.html)");
+  if (filePath.isEmpty()) {
+    return;
+  }
+
+  const ReportGenerator::Format format =
+      filePath.endsWith(".html", Qt::CaseInsensitive) ? ReportGenerator::Html
+                                                      : ReportGenerator::Markdown;
+  QSaveFile file(filePath);
+  if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    file.write(ReportGenerator(engine).render(period, today, format).toUtf8());
+    file.commit();
+  }
+}
+
+void StatisticsWindow::populateYears() {
+  const int currentYear = QDate::currentDate().year();
+  const QDate first = engine->firstRecordedDay();
+  const int firstYear = first.isValid() ? first.year() : currentYear;
+
+  QSignalBlocker blocker(yearComboBox);
+  yearComboBox->clear();
+  for (int y = currentYear; y >= firstYear; --y) {
+    yearComboBox->addItem(QString("%1年").arg(y), y);
+  }
+  yearComboBox->setCurrentIndex(0);
+  heatmap->setYear(currentYear);
+}
+
+void StatisticsWindow::updateCharts() {
+  const int year = yearComboBox->currentData().toInt();
+  const auto days = engine->dailyRange(QDate(year, 1, 1), QDate(year, 12, 31));
+
+  // 按星期汇总：遍历当年的日汇总桶
+  static const char *weekdayNames[] = {"周一", "周二", "周三", "周四",
+                                       "周五", "周六", "周日"};
+  double weekdayMinutes[7] = {0};
+  qint64 focusSeconds = 0;
+  int pomodoros = 0;
+  for (auto it = days.cbegin(); it != days.cend(); ++it) {
+    weekdayMinutes[it.key().dayOfWeek() - 1] += it.value().focusSeconds / 60.0;
+    focusSeconds += it.value().focusSeconds;
+    pomodoros += it.value().workCount;
+  }
+
+  QList<QPair<QString, double>> weekdayData;
+  for (int i = 0; i < 7; ++i) {
+    weekdayData.append(qMakePair(QString(weekdayNames[i]), weekdayMinutes[i]));
+  }
+  weekdayChart->setData(weekdayData);
+
+  // 按主题：取专注时间最多的8个主题
+  QList<QPair<QString, double>> themeData;
+  const auto themes =
+      engine->themeRange(QDate(year, 1, 1), QDate(year, 12, 31));
+  for (auto it = themes.cbegin(); it != themes.cend(); ++it) {
+    themeData.append(qMakePair(it.key().isEmpty() ? QString("未命名") : it.key(),
+                               it.value().focusSeconds / 60.0));
+  }
+  std::sort(themeData.begin(), themeData.end(),
+            [](const auto &a, const auto &b) { return a.second > b.second; });
+  themeChart->setData(themeData.mid(0, 8));
+
+  summaryLabel->setText(QString("全年专注 %1 小时 %2 分钟，完成 %3 个番茄钟")
+                            .arg(focusSeconds / 3600)
+                            .arg(focusSeconds % 3600 / 60)
+                            .arg(pomodoros));
+}
+
+void StatisticsWindow::onYearChanged(int index) {
+  heatmap->setYear(yearComboBox->itemData(index).toInt());
+  updateCharts();
+}
+
+void StatisticsWindow::onIntervalRecorded(const IntervalRecord &record) {
+  // 跨越午夜的时段同时计入了结束的那一天
+  const QDate last =
+      record.end.isValid() ? record.end.date() : record.start.date();
+  for (QDate date = record.start.date(); date <= last; date = date.addDays(1)) {
+    heatmap->updateDay(date);
+  }
+  updateCharts(); // 图表只遍历当年的日汇总，开销很小
+}
+
+void StatisticsWindow::reload() {
+  // 汇总被整体重建，所有缓存图块都已过期
+  heatmap->invalidate();
+  populateYears();
+  updateCharts();
+}
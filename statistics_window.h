@@ -0,0 +1,110 @@
+#ifndef STATISTICS_WINDOW_H
+#define STATISTICS_WINDOW_H
+
+#include <QComboBox>
+#include <QHash>
+#include <QImage>
+#include <QLabel>
+#include <QList>
+#include <QPair>
+#include <QPushButton>
+#include <QTimer>
+#include <QWidget>
+
+#include "report_generator.h"
+#include "statistics_engine.h"
+
+// 年度热力图：每个月渲染一次并缓存为图像，
+// 完成一个番茄钟时只重绘当天对应的格子
+class HeatmapView : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit HeatmapView(StatisticsEngine *engine, QWidget *parent = nullptr);
+
+  void setYear(int year);
+  void setDarkTheme(bool dark);
+  void updateDay(const QDate &date);
+  void invalidate(); // 清空全部图块缓存
+  int cachedTileCount() const { return tiles.size(); }
+
+  QSize sizeHint() const override;
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+  void mouseMoveEvent(QMouseEvent *event) override;
+
+private slots:
+  void onDayChanged();
+
+private:
+  void scheduleDayChange();
+  int tileKey(int year, int month) const;
+  QPoint tileOrigin(int month) const;
+  QRect cellRect(const QDate &date) const; // 相对于月份图块
+  QDate dateAt(const QPoint &pos) const;
+  QColor levelColor(qint64 focusSeconds) const;
+  const QImage &tile(int month);
+  QImage renderTile(int year, int month) const;
+  void paintCell(QPainter &painter, const QDate &date) const;
+
+  StatisticsEngine *engine;
+  int year;
+  bool isDarkTheme;
+  qreal cachedDpr;
+  QHash<int, QImage> tiles; // 月份图块缓存（不含今天的边框）
+  QTimer *dayChangeTimer;   // 午夜时重绘今天的边框
+};
+
+// 简单的横向柱状图
+class BarChart : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit BarChart(const QString &title, QWidget *parent = nullptr);
+
+  void setData(const QList<QPair<QString, double>> &data);
+  void setDarkTheme(bool dark);
+
+  QSize sizeHint() const override;
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+
+private:
+  QString title;
+  QList<QPair<QString, double>> bars;
+  bool isDarkTheme;
+};
+
+// 统计窗口：年度热力图以及按主题、按星期的专注时间图表
+class StatisticsWindow : public QWidget {
+  Q_OBJECT
+
+public:
+  explicit StatisticsWindow(StatisticsEngine *engine,
+                            QWidget *parent = nullptr);
+
+  void setDarkTheme(bool dark);
+
+private slots:
+  void onYearChanged(int index);
+  void onIntervalRecorded(const IntervalRecord &record);
+  void reload();
+
+private:
+  void exportReport(ReportGenerator::Period period); // 导出当前周期的报告
+  void populateYears();
+  void updateCharts();
+
+  StatisticsEngine *engine;
+  QComboBox *yearComboBox;
+  QLabel *summaryLabel;
+  QPushButton *reportButton;
+  HeatmapView *heatmap;
+  BarChart *themeChart;
+  BarChart *weekdayChart;
+  bool isDarkTheme;
+};
+
+#endif // STATISTICS_WINDOW_H
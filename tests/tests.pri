@@ -0,0 +1,6 @@
+# 各测试共用的配置，源文件直接引用仓库根目录下的实现
+QT += testlib
+CONFIG += testcase console c++17
+CONFIG -= app_bundle
+SRC_DIR = $$PWD/..
+INCLUDEPATH += $$SRC_DIR
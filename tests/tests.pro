@@ -0,0 +1,9 @@
+# 单元测试：qmake && make check
+TEMPLATE = subdirs
+SUBDIRS += tst_tone_synth \
+           tst_statistics_engine \
+           tst_session_history \
+           tst_idle_monitor \
+           tst_state_file \
+           tst_report_generator \
+           tst_hook_runner
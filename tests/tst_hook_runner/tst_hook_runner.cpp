@@ -0,0 +1,157 @@
+#include "hook_runner.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace {
+
+// 把标准输入（事件的JSON）追加为output中的一行
+QString recordCommand(const QString &output) {
+  return QString("sh -c \"cat >> '%1'; echo >> '%1'\"").arg(output);
+}
+
+// 把固定的文字追加为output中的一行
+QString markCommand(const QString &output, const QString &mark) {
+  return QString("sh -c \"echo %1 >> '%2'\"").arg(mark, output);
+}
+
+QStringList readLines(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return QStringList();
+  }
+  return QString::fromUtf8(file.readAll()).split('\n', Qt::SkipEmptyParts);
+}
+
+bool idle(const HookWorker &worker) {
+  return worker.runningCount() == 0 && worker.queuedCount() == 0;
+}
+
+} // namespace
+
+class TestHookRunner : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void queueDropsOldest();
+  void coalescesQueuedEvents();
+  void killsOnTimeout();
+  void failedToStart();
+};
+
+void TestHookRunner::initTestCase() {
+#ifdef Q_OS_WIN
+  QSKIP("钩子命令使用sh");
+#endif
+}
+
+// 排队达到上限时丢弃最早的任务，其余任务按顺序执行
+void TestHookRunner::queueDropsOldest() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString output = dir.filePath("events");
+  HookRunner::Config config;
+  config.maxConcurrent = 1;
+  config.maxQueued = 2;
+  for (int i = 0; i < HookRunner::EventCount; ++i) {
+    const HookRunner::Event event = HookRunner::Event(i);
+    config.commands[i] << markCommand(output, HookRunner::eventName(event));
+  }
+  HookWorker worker(config);
+
+  // 事件循环没有运行，第一个进程不会结束，后面的事件都在排队
+  worker.enqueue(HookRunner::Start, QJsonObject());
+  QCOMPARE(worker.runningCount(), 1);
+  worker.enqueue(HookRunner::Pause, QJsonObject());
+  worker.enqueue(HookRunner::PhaseSwitch, QJsonObject());
+  QCOMPARE(worker.queuedCount(), 2);
+
+  QTest::ignoreMessage(QtWarningMsg, QRegularExpression("队列已满.*pause"));
+  worker.enqueue(HookRunner::ThemeSaved, QJsonObject());
+  QCOMPARE(worker.queuedCount(), 2);
+  QCOMPARE(worker.droppedCount(), 1);
+
+  QTRY_VERIFY(idle(worker));
+  QCOMPARE(readLines(output), QStringList() << "start"
+                                            << "phaseSwitch"
+                                            << "themeSaved");
+}
+
+// 同一钩子还在排队时只保留最新的事件，并记录合并掉的次数
+void TestHookRunner::coalescesQueuedEvents() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString output = dir.filePath("payloads");
+  HookRunner::Config config;
+  config.maxConcurrent = 1;
+  config.commands[HookRunner::Start] << recordCommand(output);
+  HookWorker worker(config);
+
+  for (int i = 1; i <= 4; ++i) {
+    worker.enqueue(HookRunner::Start, QJsonObject{{"n", i}});
+  }
+  QCOMPARE(worker.runningCount(), 1);
+  QCOMPARE(worker.queuedCount(), 1);
+  QCOMPARE(worker.droppedCount(), 0);
+
+  QTRY_VERIFY(idle(worker));
+  const QStringList lines = readLines(output);
+  QCOMPARE(lines.size(), 2);
+  const QJsonObject first = QJsonDocument::fromJson(lines[0].toUtf8()).object();
+  const QJsonObject last = QJsonDocument::fromJson(lines[1].toUtf8()).object();
+  QCOMPARE(first.value("n").toInt(), 1);
+  QCOMPARE(first.value("coalesced").toInt(), 0);
+  QCOMPARE(last.value("n").toInt(), 4);
+  QCOMPARE(last.value("coalesced").toInt(), 2);
+}
+
+// 超时的进程被结束，之后排队的任务继续执行
+void TestHookRunner::killsOnTimeout() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString output = dir.filePath("events");
+  HookRunner::Config config;
+  config.maxConcurrent = 1;
+  config.timeoutMs = 200;
+  config.commands[HookRunner::Start] << "sleep 30";
+  config.commands[HookRunner::Pause] << markCommand(output, "pause");
+  HookWorker worker(config);
+
+  QElapsedTimer elapsed;
+  elapsed.start();
+  QTest::ignoreMessage(QtWarningMsg, QRegularExpression("start 钩子超时"));
+  worker.enqueue(HookRunner::Start, QJsonObject());
+  worker.enqueue(HookRunner::Pause, QJsonObject());
+  QCOMPARE(worker.queuedCount(), 1);
+
+  QTRY_VERIFY(idle(worker));
+  QVERIFY(elapsed.elapsed() < 10000);
+  QCOMPARE(readLines(output), QStringList() << "pause");
+}
+
+// 启动失败时释放占用的进程槽位，排队的任务照常执行
+void TestHookRunner::failedToStart() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString output = dir.filePath("events");
+  HookRunner::Config config;
+  config.maxConcurrent = 1;
+  config.commands[HookRunner::Start] << dir.filePath("missing-hook");
+  config.commands[HookRunner::Pause] << markCommand(output, "pause");
+  HookWorker worker(config);
+
+  QTest::ignoreMessage(QtWarningMsg, QRegularExpression("无法启动 start 钩子"));
+  worker.enqueue(HookRunner::Start, QJsonObject());
+  worker.enqueue(HookRunner::Pause, QJsonObject());
+
+  QTRY_VERIFY(idle(worker));
+  QCOMPARE(worker.runningCount(), 0);
+  QCOMPARE(readLines(output), QStringList() << "pause");
+}
+
+QTEST_GUILESS_MAIN(TestHookRunner)
+#include "tst_hook_runner.moc"
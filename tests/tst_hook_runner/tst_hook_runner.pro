@@ -0,0 +1,8 @@
+include(../tests.pri)
+QT -= gui
+TARGET = tst_hook_runner
+SOURCES += tst_hook_runner.cpp \
+           $$SRC_DIR/hook_runner.cpp \
+           $$SRC_DIR/state_file.cpp
+HEADERS += $$SRC_DIR/hook_runner.h \
+           $$SRC_DIR/state_file.h
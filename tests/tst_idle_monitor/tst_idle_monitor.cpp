@@ -0,0 +1,101 @@
+#include "idle_monitor.h"
+#include <QSignalSpy>
+#include <QtTest>
+
+namespace {
+
+const int ThresholdSeconds = 2;
+const int WaitMs = 5000; // 检查间隔最短1秒，留足余量
+const qint64 ToleranceMs = 1500; // 检查时刻与设置空闲时间之间的误差
+
+} // namespace
+
+class TestIdleMonitor : public QObject {
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+
+  void belowThresholdStaysActive();
+  void awaySpan();
+  void disabledDoesNotPoll();
+
+private:
+  IdleMonitor *monitor = nullptr;
+  FakeIdleSource *source = nullptr; // 由monitor持有
+};
+
+void TestIdleMonitor::init() {
+  monitor = new IdleMonitor;
+  auto fake = std::make_unique<FakeIdleSource>();
+  source = fake.get();
+  monitor->setSource(std::move(fake));
+  monitor->setThreshold(ThresholdSeconds);
+}
+
+void TestIdleMonitor::cleanup() {
+  delete monitor;
+  monitor = nullptr;
+  source = nullptr;
+}
+
+// 空闲时间没有达到阈值时不发出信号，但会继续检查
+void TestIdleMonitor::belowThresholdStaysActive() {
+  QSignalSpy started(monitor, &IdleMonitor::idleStarted);
+  source->setIdleMs(ThresholdSeconds * 1000 - 500);
+  monitor->setActive(true);
+
+  QTRY_VERIFY_WITH_TIMEOUT(monitor->pollCount() >= 2, WaitMs);
+  QCOMPARE(started.count(), 0);
+}
+
+// 离开的开始时间按空闲时间回推，回来的时间按新的空闲时间回推
+void TestIdleMonitor::awaySpan() {
+  QSignalSpy started(monitor, &IdleMonitor::idleStarted);
+  QSignalSpy ended(monitor, &IdleMonitor::idleEnded);
+  monitor->setActive(true);
+
+  const qint64 awayMs = 10 * 60 * 1000;
+  source->setIdleMs(awayMs);
+  QTRY_COMPARE_WITH_TIMEOUT(started.count(), 1, WaitMs);
+  const QDateTime since = started.at(0).at(0).toDateTime();
+  const QDateTime expectedSince =
+      QDateTime::currentDateTime().addMSecs(-awayMs);
+  QVERIFY(qAbs(since.msecsTo(expectedSince)) < ToleranceMs);
+
+  // 离开期间不重复发出信号
+  QTest::qWait(1500);
+  QCOMPARE(started.count(), 1);
+  QCOMPARE(ended.count(), 0);
+
+  const qint64 returnedMs = 300;
+  source->setIdleMs(returnedMs);
+  QTRY_COMPARE_WITH_TIMEOUT(ended.count(), 1, WaitMs);
+  QCOMPARE(ended.at(0).at(0).toDateTime(), since);
+  const QDateTime until = ended.at(0).at(1).toDateTime();
+  const QDateTime expectedUntil =
+      QDateTime::currentDateTime().addMSecs(-returnedMs);
+  QVERIFY(qAbs(until.msecsTo(expectedUntil)) < ToleranceMs);
+  QVERIFY(since < until);
+}
+
+// 阈值为0或未激活时不查询空闲来源
+void TestIdleMonitor::disabledDoesNotPoll() {
+  QSignalSpy started(monitor, &IdleMonitor::idleStarted);
+  source->setIdleMs(60 * 60 * 1000);
+
+  monitor->setThreshold(0);
+  monitor->setActive(true);
+  QTest::qWait(1500);
+  QCOMPARE(monitor->pollCount(), qint64(0));
+
+  monitor->setThreshold(ThresholdSeconds);
+  monitor->setActive(false);
+  QTest::qWait(1500);
+  QCOMPARE(monitor->pollCount(), qint64(0));
+  QCOMPARE(started.count(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestIdleMonitor)
+#include "tst_idle_monitor.moc"
@@ -0,0 +1,6 @@
+include(../tests.pri)
+TARGET = tst_idle_monitor
+SOURCES += tst_idle_monitor.cpp \
+           $$SRC_DIR/idle_monitor.cpp
+HEADERS += $$SRC_DIR/idle_monitor.h
+macx: LIBS += -framework IOKit -framework CoreFoundation
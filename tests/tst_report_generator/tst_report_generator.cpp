@@ -0,0 +1,185 @@
+#include "report_generator.h"
+#include "statistics_engine.h"
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace {
+
+const char *CacheFileName = ".report-cache.json";
+const int Weeks = 3; // 两周前、上周和本周
+
+IntervalRecord workRecord(const QDateTime &start, const QString &theme) {
+  IntervalRecord record;
+  record.start = start;
+  record.end = start.addSecs(1500);
+  record.plannedSeconds = 1500;
+  record.actualSeconds = 1500;
+  record.isWork = true;
+  record.theme = theme;
+  return record;
+}
+
+// 两周前和今天各记录一个番茄钟，报告覆盖三个周
+void recordWeeks(const QString &dataDir) {
+  const QDate today = QDate::currentDate();
+  StatisticsEngine engine(dataDir);
+  engine.recordInterval(
+      workRecord(QDateTime(today.addDays(-14), QTime(9, 0)), "写作"));
+  engine.recordInterval(workRecord(QDateTime(today, QTime(0, 1)), "阅读"));
+}
+
+QJsonObject readCache(const QString &outputDir) {
+  QFile file(outputDir + "/" + CacheFileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QJsonObject();
+  }
+  return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+bool writeCache(const QString &outputDir, const QJsonObject &cache) {
+  QFile file(outputDir + "/" + CacheFileName);
+  return file.open(QIODevice::WriteOnly | QIODevice::Truncate) &&
+         file.write(QJsonDocument(cache).toJson()) > 0;
+}
+
+} // namespace
+
+class TestReportGenerator : public QObject {
+  Q_OBJECT
+
+private slots:
+  void skipsEndedPeriods();
+  void regeneratesOnChange();
+  void batchSubdirectories();
+};
+
+// 第二次生成时已结束的周期直接跳过，只重新生成当前周期
+void TestReportGenerator::skipsEndedPeriods() {
+  QTemporaryDir data;
+  QTemporaryDir output;
+  QVERIFY(data.isValid() && output.isValid());
+  recordWeeks(data.path());
+
+  StatisticsEngine engine(data.path(), StatisticsEngine::ReadOnly);
+  ReportGenerator generator(&engine);
+  int written = 0;
+  int skipped = 0;
+  QVERIFY(generator.generateAll(ReportGenerator::Weekly,
+                                ReportGenerator::Markdown, output.path(),
+                                &written, &skipped));
+  QCOMPARE(written, Weeks);
+  QCOMPARE(skipped, 0);
+
+  QVERIFY(generator.generateAll(ReportGenerator::Weekly,
+                                ReportGenerator::Markdown, output.path(),
+                                &written, &skipped));
+  QCOMPARE(written, 1);
+  QCOMPARE(skipped, Weeks - 1);
+
+  // 报告文件被删除时重新生成
+  const QDate start = ReportGenerator::periodStart(
+      ReportGenerator::Weekly, QDate::currentDate().addDays(-14));
+  QVERIFY(QFile::remove(output.filePath(ReportGenerator::fileName(
+      ReportGenerator::Weekly, start, ReportGenerator::Markdown))));
+  QVERIFY(generator.generateAll(ReportGenerator::Weekly,
+                                ReportGenerator::Markdown, output.path(),
+                                &written, &skipped));
+  QCOMPARE(written, 2);
+  QCOMPARE(skipped, Weeks - 2);
+}
+
+// 原始历史或模板变化后，已结束的周期重新计算，内容变化的报告重新写入
+void TestReportGenerator::regeneratesOnChange() {
+  QTemporaryDir data;
+  QTemporaryDir output;
+  QVERIFY(data.isValid() && output.isValid());
+  recordWeeks(data.path());
+  const auto generate = [&](int *written, int *skipped) {
+    StatisticsEngine engine(data.path(), StatisticsEngine::ReadOnly);
+    return ReportGenerator(&engine).generateAll(
+        ReportGenerator::Weekly, ReportGenerator::Markdown, output.path(),
+        written, skipped);
+  };
+  int written = 0;
+  int skipped = 0;
+  QVERIFY(generate(&written, &skipped));
+  QCOMPARE(written, Weeks);
+
+  // 模拟旧版本模板生成的报告：指纹全部不同。标识未变时仍被跳过
+  QJsonObject cache = readCache(output.path());
+  const QString source = cache.value(".source").toString();
+  QVERIFY(source.count(':') >= 2); // 原始历史标识后附加模板摘要
+  for (const QString &key : cache.keys()) {
+    if (!key.startsWith('.')) {
+      cache[key] = "old-template";
+    }
+  }
+  QVERIFY(writeCache(output.path(), cache));
+  QVERIFY(generate(&written, &skipped));
+  QCOMPARE(written, 1);
+
+  // 模板摘要变化：全部重新计算，指纹不同的报告都重新写入
+  cache = readCache(output.path());
+  cache[".source"] = source.section(':', 0, -2) + ":00000000";
+  QVERIFY(writeCache(output.path(), cache));
+  QVERIFY(generate(&written, &skipped));
+  QCOMPARE(written, Weeks);
+  QCOMPARE(skipped, 0);
+  QCOMPARE(readCache(output.path()).value(".source").toString(), source);
+
+  // 原始历史变化：只有数据变化的周期和当前周期重新写入
+  {
+    StatisticsEngine engine(data.path());
+    engine.recordInterval(workRecord(
+        QDateTime(QDate::currentDate().addDays(-7), QTime(9, 0)), "写作"));
+  }
+  QVERIFY(generate(&written, &skipped));
+  QCOMPARE(written, 2);
+  QCOMPARE(skipped, Weeks - 2);
+}
+
+// 同名的数据目录输出到不同的子目录，重复或不存在的目录直接失败
+void TestReportGenerator::batchSubdirectories() {
+  QTemporaryDir root;
+  QVERIFY(root.isValid());
+  const QString first = root.filePath("a/QtPomodoro");
+  const QString second = root.filePath("b/QtPomodoro");
+  QVERIFY(QDir().mkpath(first));
+  QVERIFY(QDir().mkpath(second));
+  recordWeeks(first);
+  recordWeeks(second);
+  const QString output = root.filePath("reports");
+
+  QVERIFY(ReportGenerator::generateBatch(
+      ReportGenerator::Weekly, ReportGenerator::Markdown,
+      QStringList() << first << second, output));
+  const QStringList subdirs =
+      QDir(output).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+  QCOMPARE(subdirs.size(), 2);
+  const QString current = ReportGenerator::fileName(
+      ReportGenerator::Weekly,
+      ReportGenerator::periodStart(ReportGenerator::Weekly,
+                                   QDate::currentDate()),
+      ReportGenerator::Markdown);
+  for (const QString &subdir : subdirs) {
+    QVERIFY2(subdir.startsWith("QtPomodoro-"), qPrintable(subdir));
+    QVERIFY(QFile::exists(output + "/" + subdir + "/" + current));
+  }
+
+  // 只读打开，不在数据目录中写入报告或缓存
+  QVERIFY(!QFile::exists(first + "/" + current));
+
+  QVERIFY(!ReportGenerator::generateBatch(
+      ReportGenerator::Weekly, ReportGenerator::Markdown,
+      QStringList() << first << first + "/", output));
+  QVERIFY(!ReportGenerator::generateBatch(
+      ReportGenerator::Weekly, ReportGenerator::Markdown,
+      QStringList() << first << root.filePath("missing"), output));
+}
+
+QTEST_GUILESS_MAIN(TestReportGenerator)
+#include "tst_report_generator.moc"
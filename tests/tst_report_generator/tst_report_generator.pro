@@ -0,0 +1,12 @@
+include(../tests.pri)
+QT += concurrent
+QT -= gui
+TARGET = tst_report_generator
+SOURCES += tst_report_generator.cpp \
+           $$SRC_DIR/report_generator.cpp \
+           $$SRC_DIR/statistics_engine.cpp \
+           $$SRC_DIR/state_file.cpp
+HEADERS += $$SRC_DIR/report_generator.h \
+           $$SRC_DIR/statistics_engine.h \
+           $$SRC_DIR/state_file.h
+RESOURCES += $$SRC_DIR/resources.qrc
@@ -0,0 +1,307 @@
+#include "session_history.h"
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtTest>
+#include <atomic>
+
+namespace {
+
+const int StressEntries = 20000;
+const int MinAppendsPerSecond = 2000; // 导出期间仍需保持的最低追加速率
+const qint64 MaxAppendNs = 50 * 1000 * 1000; // 单次追加的最长耗时
+
+// 本月第一天零点，所有记录都落在本月的热文件中
+QDateTime monthStart() {
+  const QDate today = QDate::currentDate();
+  return QDateTime(QDate(today.year(), today.month(), 1), QTime(0, 0));
+}
+
+// 检查一次导出：条数与快照一致，并且正好是从0开始连续的前缀
+QString checkExport(const HistorySnapshot &snapshot, const QDateTime &from,
+                    const QDateTime &to, qint64 *exported) {
+  const qint64 size = snapshot.size();
+  const QList<QPair<QDateTime, QString>> themes = snapshot.range(from, to);
+  if (themes.size() != size) {
+    return QString("导出 %1 条，快照有 %2 条").arg(themes.size()).arg(size);
+  }
+  for (int i = 0; i < themes.size(); ++i) {
+    if (themes[i].second != QString::number(i) ||
+        themes[i].first != from.addMSecs(i)) {
+      return QString("第 %1 条为 %2").arg(i).arg(themes[i].second);
+    }
+  }
+  *exported = size;
+  return QString();
+}
+
+using ThemeList = QList<QPair<QDateTime, QString>>;
+
+// 在指定月份的第一天写入count条记录，每条间隔一分钟
+void appendMonth(SessionHistory &history, const QDateTime &start, int count) {
+  for (int i = 0; i < count; ++i) {
+    history.append(start.addSecs(60 * i),
+                   start.toString("yyyy-MM") + "#" + QString::number(i));
+  }
+}
+
+} // namespace
+
+class TestSessionHistory : public QObject {
+  Q_OBJECT
+
+private slots:
+  void exportWhileAppending();
+  void compactionRoundTrip();
+  void segmentLookup();
+  void interruptedSeal();
+  void resealKeepsSnapshot();
+};
+
+// 一边以每秒数千条的速度追加，一边在另一个线程中反复导出
+void TestSessionHistory::exportWhileAppending() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  SessionHistory history(dir.path());
+
+  const QDateTime from = monthStart();
+  const QDateTime to = from.addDays(1);
+
+  std::atomic<bool> done(false);
+  int exports = 0;
+  QString failure;
+  QThread *reader = QThread::create([&] {
+    qint64 previous = 0;
+    HistorySnapshot first;
+    qint64 firstSize = -1;
+    while (!done.load() && failure.isEmpty()) {
+      const HistorySnapshot snapshot = history.snapshot();
+      qint64 exported = 0;
+      failure = checkExport(snapshot, from, to, &exported);
+      if (failure.isEmpty() && exported < previous) {
+        failure = QString("导出条数从 %1 减少到 %2").arg(previous).arg(exported);
+      }
+      previous = exported;
+      if (firstSize < 0 && exported > 0) {
+        first = snapshot;
+        firstSize = exported;
+      }
+      ++exports;
+    }
+
+    // 早先的快照不受之后追加的影响
+    if (failure.isEmpty() && firstSize >= 0) {
+      qint64 exported = 0;
+      failure = checkExport(first, from, to, &exported);
+      if (failure.isEmpty() && exported != firstSize) {
+        failure = QString("旧快照从 %1 条变为 %2 条").arg(firstSize).arg(exported);
+      }
+    }
+  });
+  reader->start();
+
+  QElapsedTimer total;
+  QElapsedTimer timer;
+  qint64 slowest = 0;
+  total.start();
+  for (int i = 0; i < StressEntries; ++i) {
+    timer.start();
+    history.append(from.addMSecs(i), QString::number(i));
+    slowest = std::max(slowest, timer.nsecsElapsed());
+  }
+  const qint64 elapsedMs = std::max<qint64>(total.elapsed(), 1);
+
+  done.store(true);
+  reader->wait();
+  delete reader;
+
+  QVERIFY2(failure.isEmpty(), qPrintable(failure));
+  QVERIFY(exports > 0);
+  const qint64 rate = StressEntries * 1000 / elapsedMs;
+  qInfo("追加 %d 条用时 %lld ms（%lld 条/秒），最慢一次 %lld us，导出 %d 次",
+        StressEntries, elapsedMs, rate, slowest / 1000, exports);
+  QVERIFY2(rate >= MinAppendsPerSecond, qPrintable(QString::number(rate)));
+  QVERIFY2(slowest < MaxAppendNs, qPrintable(QString::number(slowest)));
+
+  // 追加结束后的快照包含全部记录，重新加载后也完全一致
+  qint64 exported = 0;
+  QCOMPARE(checkExport(history.snapshot(), from, to, &exported), QString());
+  QCOMPARE(exported, qint64(StressEntries));
+  SessionHistory reloaded(dir.path());
+  QCOMPARE(checkExport(reloaded.snapshot(), from, to, &exported), QString());
+  QCOMPARE(exported, qint64(StressEntries));
+}
+
+// 压缩前后、重新加载后，条数和查询结果都保持不变
+void TestSessionHistory::compactionRoundTrip() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QDateTime current = monthStart();
+  const QDateTime all = current.addYears(-1);
+  const QDateTime end = current.addMonths(1);
+
+  SessionHistory history(dir.path());
+  appendMonth(history, current.addMonths(-2), 1500); // 跨越内存中的段边界
+  appendMonth(history, current.addMonths(-1), 300);
+  appendMonth(history, current, 200);
+  QVERIFY(history.needsCompaction());
+
+  const ThemeList before = history.snapshot().range(all, end);
+  QCOMPARE(before.size(), 2000);
+  QCOMPARE(history.snapshot().size(), qint64(2000));
+
+  const HistoryCompaction result = history.compact();
+  QCOMPARE(result.months.size(), 2);
+  QVERIFY(result.diskAfter < result.diskBefore);
+  history.applyCompaction(result);
+  QVERIFY(!history.needsCompaction());
+
+  // 压缩段的记录也计入快照的条数
+  const HistorySnapshot snapshot = history.snapshot();
+  QCOMPARE(snapshot.size(), qint64(2000));
+  QCOMPARE(snapshot.range(all, end), before);
+
+  SessionHistory reloaded(dir.path());
+  QCOMPARE(reloaded.snapshot().size(), qint64(2000));
+  QCOMPARE(reloaded.snapshot().range(all, end), before);
+}
+
+// 封存段按头部中的时间范围查找，索引中的头部与文件一致时不再读取
+void TestSessionHistory::segmentLookup() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QDateTime current = monthStart();
+  const QDateTime older = current.addMonths(-2);
+  const QDateTime previous = current.addMonths(-1);
+  {
+    SessionHistory history(dir.path());
+    appendMonth(history, older, 50);
+    appendMonth(history, previous, 30);
+    appendMonth(history, current, 10);
+    history.applyCompaction(history.compact());
+  }
+
+  HistoryArchive archive(dir.path());
+  int headersRead = 0;
+  const QList<ArchiveSegment> segments =
+      archive.sealedSegments(QList<ArchiveSegment>(), &headersRead);
+  QCOMPARE(segments.size(), 2);
+  QCOMPARE(headersRead, 2);
+  QCOMPARE(segments[0].count, 50);
+  QCOMPARE(segments[0].minTs, older.toMSecsSinceEpoch());
+  QCOMPARE(segments[0].maxTs, older.addSecs(60 * 49).toMSecsSinceEpoch());
+  QCOMPARE(segments[1].count, 30);
+  QCOMPARE(HistoryArchive::readSegment(segments[1]).size(), 30);
+
+  // 用上一次的结果作为索引：头部全部复用
+  headersRead = 0;
+  const QList<ArchiveSegment> reused =
+      archive.sealedSegments(segments, &headersRead);
+  QCOMPARE(headersRead, 0);
+  QCOMPARE(reused.size(), 2);
+  QCOMPARE(reused[1].count, 30);
+  QCOMPARE(reused[1].path, segments[1].path);
+
+  // 文件大小与索引不符的段重新读取头部
+  QList<ArchiveSegment> stale = segments;
+  stale[0].bytes += 1;
+  stale[0].count = 0;
+  headersRead = 0;
+  QCOMPARE(archive.sealedSegments(stale, &headersRead).at(0).count, 50);
+  QCOMPARE(headersRead, 1);
+
+  // 查询只返回范围内的记录，其他月份的段被跳过
+  SessionHistory history(dir.path());
+  const ThemeList themes =
+      history.snapshot().range(previous, previous.addSecs(60 * 9));
+  QCOMPARE(themes.size(), 10);
+  QCOMPARE(themes.first().second, previous.toString("yyyy-MM") + "#0");
+  QCOMPARE(themes.last().second, previous.toString("yyyy-MM") + "#9");
+}
+
+// 封存中途崩溃：段已写入时丢弃.sealing，未写入时恢复为热文件，记录不重复也不丢失
+void TestSessionHistory::interruptedSeal() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QDateTime previous = monthStart().addMonths(-1);
+  const QString month = previous.toString("yyyy-MM");
+  const QString hot = dir.filePath(month + ".hot");
+  const QString backup = dir.filePath("hot.backup");
+  const QString sealing = dir.filePath(month + ".seg.sealing");
+  {
+    HistoryArchive archive(dir.path());
+    for (int i = 0; i < 5; ++i) {
+      QVERIFY(archive.append({previous.addSecs(60 * i).toMSecsSinceEpoch(),
+                              QString::number(i)}));
+    }
+    QVERIFY(QFile::copy(hot, backup));
+    ArchiveSegment segment;
+    QVERIFY(archive.sealMonth(month, &segment));
+    QCOMPARE(segment.count, 5);
+    QVERIFY(!QFile::exists(hot));
+  }
+
+  // 段提交之后、删除.sealing之前崩溃
+  QVERIFY(QFile::copy(backup, sealing));
+  {
+    HistoryArchive archive(dir.path());
+    QVERIFY(!QFile::exists(sealing));
+    QVERIFY(archive.readHotEntries().isEmpty());
+    const QList<ArchiveSegment> segments = archive.sealedSegments();
+    QCOMPARE(segments.size(), 1);
+    QCOMPARE(segments[0].count, 5);
+  }
+
+  // 段提交之前崩溃
+  QVERIFY(QFile::remove(dir.filePath(month + ".seg")));
+  QVERIFY(QFile::copy(backup, sealing));
+  {
+    HistoryArchive archive(dir.path());
+    QVERIFY(!QFile::exists(sealing));
+    QVERIFY(archive.sealedSegments().isEmpty());
+    QCOMPARE(archive.readHotEntries().size(), 5);
+    QCOMPARE(archive.hotMonthsBefore(QDate::currentDate()),
+             QStringList() << month);
+  }
+}
+
+// 重新封存同一个月写入新一代的段，之前的快照仍能读取旧段
+void TestSessionHistory::resealKeepsSnapshot() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QDateTime current = monthStart();
+  const QDateTime previous = current.addMonths(-1);
+  const QDateTime all = current.addYears(-1);
+  const QDateTime end = current.addMonths(1);
+  QString firstPath;
+  {
+    SessionHistory history(dir.path());
+    appendMonth(history, previous, 40);
+    history.applyCompaction(history.compact());
+    const HistorySnapshot before = history.snapshot();
+    QCOMPARE(before.range(all, end).size(), 40);
+
+    // 系统时间被调回，上个月又有新的记录
+    appendMonth(history, previous.addDays(1), 20);
+    QVERIFY(history.needsCompaction());
+    const HistoryCompaction result = history.compact();
+    QCOMPARE(result.segments.size(), 1);
+    QCOMPARE(result.segments[0].count, 60);
+    firstPath = dir.filePath(previous.toString("yyyy-MM") + ".seg");
+    QVERIFY(result.segments[0].path != firstPath);
+    history.applyCompaction(result);
+
+    QCOMPARE(before.range(all, end).size(), 40);
+    QCOMPARE(history.snapshot().size(), qint64(60));
+    QCOMPARE(history.snapshot().range(all, end).size(), 60);
+  }
+
+  // 重新打开后旧段被删除，只剩新一代的段
+  SessionHistory reloaded(dir.path());
+  QVERIFY(!QFile::exists(firstPath));
+  QCOMPARE(reloaded.snapshot().size(), qint64(60));
+  QCOMPARE(reloaded.snapshot().range(all, end).size(), 60);
+}
+
+QTEST_GUILESS_MAIN(TestSessionHistory)
+#include "tst_session_history.moc"
@@ -0,0 +1,11 @@
+include(../tests.pri)
+QT += concurrent
+QT -= gui
+TARGET = tst_session_history
+SOURCES += tst_session_history.cpp \
+           $$SRC_DIR/session_history.cpp \
+           $$SRC_DIR/history_archive.cpp \
+           $$SRC_DIR/state_file.cpp
+HEADERS += $$SRC_DIR/session_history.h \
+           $$SRC_DIR/history_archive.h \
+           $$SRC_DIR/state_file.h
@@ -0,0 +1,167 @@
+#include "state_file.h"
+#include <QFile>
+#include <QPoint>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace {
+
+const int HeaderSize = 16;
+const int EntrySize = 16;
+
+quint32 readU32(const QByteArray &data, int pos) {
+  const uchar *u = reinterpret_cast<const uchar *>(data.constData() + pos);
+  return (quint32(u[0]) << 24) | (quint32(u[1]) << 16) |
+         (quint32(u[2]) << 8) | quint32(u[3]);
+}
+
+QByteArray readAll(const QString &path) {
+  QFile file(path);
+  return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+bool writeAll(const QString &path, const QByteArray &data) {
+  QFile file(path);
+  return file.open(QIODevice::WriteOnly | QIODevice::Truncate) &&
+         file.write(data) == data.size();
+}
+
+// 修改指定分区中间的一个字节，分区表和文件头保持不变
+QByteArray corruptSection(QByteArray data, StateFile::Section section) {
+  const int count = (uchar(data[6]) << 8) | uchar(data[7]);
+  for (int i = 0; i < count; ++i) {
+    const int entry = HeaderSize + EntrySize * i;
+    if (readU32(data, entry) == section) {
+      const int offset = int(readU32(data, entry + 4));
+      const int size = int(readU32(data, entry + 8));
+      data[offset + size / 2] = char(data[offset + size / 2] ^ 0x5a);
+      return data;
+    }
+  }
+  return QByteArray();
+}
+
+} // namespace
+
+class TestStateFile : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+
+  void sections();
+  void corruptSectionRestoredFromBackup();
+  void badHeaderRestoredFromBackup();
+  void corruptSectionWithoutBackup();
+  void backupRefreshedOncePerProcess();
+
+private:
+  // 复制写好的文件到新的目录，QSettings按路径缓存，每个用例使用新的路径
+  QString prepare(const QString &name, const QByteArray &data,
+                  bool withBackup);
+
+  QTemporaryDir dir;
+  QString source;
+};
+
+// 写入两个版本：第二次写入时，第一个版本成为state.dat.bak
+void TestStateFile::initTestCase() {
+  QVERIFY(dir.isValid());
+  source = dir.filePath("source/state.dat");
+  QVERIFY(QDir().mkpath(dir.filePath("source")));
+  {
+    QSettings settings(source, StateFile::format());
+    settings.setValue("volume", 0.3);
+    settings.setValue("Timer/completedCycles", 3);
+    settings.setValue("FloatingTimer/pos", QPoint(10, 20));
+  }
+  {
+    QSettings settings(source, StateFile::format());
+    settings.setValue("volume", 0.7);
+    settings.setValue("Timer/completedCycles", 4);
+  }
+  QVERIFY(QFile::exists(source + ".bak"));
+}
+
+QString TestStateFile::prepare(const QString &name, const QByteArray &data,
+                               bool withBackup) {
+  const QString path = dir.filePath(name + "/state.dat");
+  QDir().mkpath(dir.filePath(name));
+  writeAll(path, data);
+  if (withBackup) {
+    QFile::copy(source + ".bak", path + ".bak");
+  }
+  return path;
+}
+
+void TestStateFile::sections() {
+  QCOMPARE(StateFile::sectionOf("FloatingTimer/layouts/a/pos"),
+           StateFile::WindowGeometry);
+  QCOMPARE(StateFile::sectionOf("Timer/completedCycles"),
+           StateFile::TimerState);
+  QCOMPARE(StateFile::sectionOf("History/segments"), StateFile::HistoryIndex);
+  QCOMPARE(StateFile::sectionOf("volume"), StateFile::Settings);
+}
+
+// 只有损坏的分区从备份恢复，其他分区保留最新的值，损坏的文件另存一份
+void TestStateFile::corruptSectionRestoredFromBackup() {
+  const QByteArray corrupted =
+      corruptSection(readAll(source), StateFile::Settings);
+  QVERIFY(!corrupted.isEmpty());
+  const QString path = prepare("section", corrupted, true);
+
+  QSettings settings(path, StateFile::format());
+  QCOMPARE(settings.status(), QSettings::NoError);
+  QCOMPARE(settings.value("volume").toDouble(), 0.3);
+  QCOMPARE(settings.value("Timer/completedCycles").toInt(), 4);
+  QCOMPARE(settings.value("FloatingTimer/pos").toPoint(), QPoint(10, 20));
+  QCOMPARE(readAll(path + ".corrupt"), corrupted);
+}
+
+// 文件头（或分区表）损坏时所有分区都从备份恢复
+void TestStateFile::badHeaderRestoredFromBackup() {
+  QByteArray corrupted = readAll(source);
+  corrupted[0] = 'X';
+  const QString path = prepare("header", corrupted, true);
+
+  QSettings settings(path, StateFile::format());
+  QCOMPARE(settings.status(), QSettings::NoError);
+  QCOMPARE(settings.value("volume").toDouble(), 0.3);
+  QCOMPARE(settings.value("Timer/completedCycles").toInt(), 3);
+  QCOMPARE(settings.value("FloatingTimer/pos").toPoint(), QPoint(10, 20));
+  QCOMPARE(readAll(path + ".corrupt"), corrupted);
+}
+
+// 没有备份时损坏的分区恢复为默认值，不影响其他分区
+void TestStateFile::corruptSectionWithoutBackup() {
+  const QByteArray corrupted =
+      corruptSection(readAll(source), StateFile::TimerState);
+  QVERIFY(!corrupted.isEmpty());
+  const QString path = prepare("nobackup", corrupted, false);
+
+  QSettings settings(path, StateFile::format());
+  QCOMPARE(settings.status(), QSettings::NoError);
+  QVERIFY(!settings.contains("Timer/completedCycles"));
+  QCOMPARE(settings.value("volume").toDouble(), 0.7);
+  QCOMPARE(settings.value("FloatingTimer/pos").toPoint(), QPoint(10, 20));
+  QVERIFY(QFile::exists(path + ".corrupt"));
+}
+
+// 备份每个进程只刷新一次：之后的写入不会把备份推进到上一次写入的版本
+void TestStateFile::backupRefreshedOncePerProcess() {
+  const QString path = dir.filePath("refresh/state.dat");
+  QVERIFY(QDir().mkpath(dir.filePath("refresh")));
+  for (int cycles = 1; cycles <= 3; ++cycles) {
+    QSettings settings(path, StateFile::format());
+    settings.setValue("Timer/completedCycles", cycles);
+    settings.sync();
+  }
+
+  const QString check = prepare("refresh-check", readAll(path + ".bak"), false);
+  QSettings backup(check, StateFile::format());
+  QCOMPARE(backup.status(), QSettings::NoError);
+  QCOMPARE(backup.value("Timer/completedCycles").toInt(), 1);
+}
+
+QTEST_GUILESS_MAIN(TestStateFile)
+#include "tst_state_file.moc"
@@ -0,0 +1,6 @@
+include(../tests.pri)
+QT -= gui
+TARGET = tst_state_file
+SOURCES += tst_state_file.cpp \
+           $$SRC_DIR/state_file.cpp
+HEADERS += $$SRC_DIR/state_file.h
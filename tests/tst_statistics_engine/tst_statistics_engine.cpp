@@ -0,0 +1,104 @@
+#include "statistics_engine.h"
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace {
+
+IntervalRecord workRecord(const QDateTime &start, int planned, int actual,
+                          const QString &theme = QString()) {
+  IntervalRecord record;
+  record.start = start;
+  record.end = start.addSecs(planned);
+  record.plannedSeconds = planned;
+  record.actualSeconds = actual;
+  record.isWork = true;
+  record.theme = theme;
+  return record;
+}
+
+} // namespace
+
+class TestStatisticsEngine : public QObject {
+  Q_OBJECT
+
+private slots:
+  void focusUsesActualSeconds();
+  void legacyWallClockIsCapped();
+  void splitsAtMidnight();
+  void backgroundRebuild();
+};
+
+void TestStatisticsEngine::focusUsesActualSeconds() {
+  const QDate date(2024, 1, 10);
+  Rollups rollups;
+  rollups.add(workRecord(QDateTime(date, QTime(10, 0)), 1500, 900, "写作"));
+
+  const RollupBucket day = rollups.daily.value(date);
+  QCOMPARE(day.focusSeconds, qint64(900));
+  QCOMPARE(day.plannedSeconds, qint64(1500));
+  QCOMPARE(day.workCount, 1);
+  QCOMPARE(rollups.themes.value("写作").focusSeconds, qint64(900));
+}
+
+// 旧版本记录的实际时间包含暂停，不能超过计划时长
+void TestStatisticsEngine::legacyWallClockIsCapped() {
+  const QDate date(2024, 1, 10);
+  Rollups rollups;
+  rollups.add(workRecord(QDateTime(date, QTime(10, 0)), 1500, 4000));
+  QCOMPARE(rollups.daily.value(date).focusSeconds, qint64(1500));
+}
+
+// 周日23:50开始的30分钟：10分钟计入周日，20分钟计入周一（下一周）
+void TestStatisticsEngine::splitsAtMidnight() {
+  const QDate sunday(2024, 1, 7);
+  const QDate monday = sunday.addDays(1);
+  Rollups rollups;
+  rollups.add(workRecord(QDateTime(sunday, QTime(23, 50)), 1800, 1800, "夜读"));
+
+  QCOMPARE(rollups.daily.value(sunday).focusSeconds, qint64(600));
+  QCOMPARE(rollups.daily.value(monday).focusSeconds, qint64(1200));
+  QCOMPARE(rollups.daily.value(sunday).workCount, 1);
+  QCOMPARE(rollups.daily.value(monday).workCount, 0);
+
+  QCOMPARE(rollups.weekly.value(StatisticsEngine::weekStart(sunday))
+               .focusSeconds,
+           qint64(600));
+  QCOMPARE(rollups.weekly.value(monday).focusSeconds, qint64(1200));
+  QCOMPARE(rollups.dailyThemes.value(monday).value("夜读").focusSeconds,
+           qint64(1200));
+  QCOMPARE(rollups.themes.value("夜读").focusSeconds, qint64(1800));
+  QCOMPARE(rollups.recordCount, qint64(1));
+}
+
+// 汇总过期时在后台重建，重建期间记录的时段在完成后补进汇总
+void TestStatisticsEngine::backgroundRebuild() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QDateTime start(QDate(2024, 2, 1), QTime(9, 0));
+  {
+    StatisticsEngine writer(dir.path(), StatisticsEngine::NoRebuild);
+    for (int i = 0; i < 200; ++i) {
+      writer.recordInterval(workRecord(start.addSecs(i * 3600), 1500, 1500));
+    }
+  }
+  QVERIFY(QFile::remove(dir.filePath("rollups.dat")));
+
+  StatisticsEngine engine(dir.path(), StatisticsEngine::BackgroundRebuild);
+  QSignalSpy rebuilt(&engine, &StatisticsEngine::rollupsRebuilt);
+  QVERIFY(engine.isRebuilding());
+  engine.recordInterval(workRecord(start.addDays(30), 1500, 1200));
+
+  QVERIFY(rebuilt.wait(10000));
+  QVERIFY(!engine.isRebuilding());
+  QCOMPARE(engine.recordCount(), qint64(201));
+  QCOMPARE(engine.day(start.addDays(30).date()).focusSeconds, qint64(1200));
+
+  // 保存的汇总与原始历史一致，下次启动直接加载
+  StatisticsEngine reopened(dir.path(), StatisticsEngine::NoRebuild);
+  QCOMPARE(reopened.recordCount(), qint64(201));
+}
+
+QTEST_GUILESS_MAIN(TestStatisticsEngine)
+#include "tst_statistics_engine.moc"
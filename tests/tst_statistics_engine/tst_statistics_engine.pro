@@ -0,0 +1,9 @@
+include(../tests.pri)
+QT += concurrent
+QT -= gui
+TARGET = tst_statistics_engine
+SOURCES += tst_statistics_engine.cpp \
+           $$SRC_DIR/statistics_engine.cpp \
+           $$SRC_DIR/state_file.cpp
+HEADERS += $$SRC_DIR/statistics_engine.h \
+           $$SRC_DIR/state_file.h
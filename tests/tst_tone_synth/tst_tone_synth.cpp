@@ -0,0 +1,90 @@
+#include "tone_synth.h"
+#include <QAudioDevice>
+#include <QtTest>
+
+class TestToneSynth : public QObject {
+  Q_OBJECT
+
+private slots:
+  void nullDeviceLatency();
+  void silenceWithoutChime();
+  void sampleFormats_data();
+  void sampleFormats();
+};
+
+// 空设备时没有QAudioSink，由测试代替音频线程拉取数据，
+// 测得的延迟只包含排队到混音的时间
+void TestToneSynth::nullDeviceLatency() {
+  ToneSynth synth{QAudioDevice()};
+  ToneStream *stream = synth.stream();
+  QVERIFY(stream);
+  QCOMPARE(synth.lastLatencyUs(), qint64(-1));
+
+  synth.play(ToneSynth::WorkEnd, 1.0f);
+  QByteArray buffer(4096, '\0');
+  QCOMPARE(stream->read(buffer.data(), buffer.size()), qint64(buffer.size()));
+
+  const qint64 latency = synth.lastLatencyUs();
+  QVERIFY(latency >= 0);
+  QVERIFY2(latency < 50000, qPrintable(QString("latency %1 us").arg(latency)));
+
+  // 提示音已经混入输出
+  const qint16 *samples = reinterpret_cast<const qint16 *>(buffer.constData());
+  bool audible = false;
+  for (int i = 0; i < buffer.size() / 2; ++i) {
+    audible = audible || samples[i] != 0;
+  }
+  QVERIFY(audible);
+}
+
+void TestToneSynth::silenceWithoutChime() {
+  ToneSynth synth{QAudioDevice()};
+  synth.play(ToneSynth::Warning, 0.0f); // 静音时不排队
+
+  // 流永不结束，没有提示音时输出静音
+  QVERIFY(synth.stream()->bytesAvailable() > 0);
+  QByteArray buffer(1024, '\x7f');
+  QCOMPARE(synth.stream()->read(buffer.data(), buffer.size()),
+           qint64(buffer.size()));
+  QCOMPARE(buffer, QByteArray(buffer.size(), '\0'));
+  QCOMPARE(synth.lastLatencyUs(), qint64(-1));
+}
+
+void TestToneSynth::sampleFormats_data() {
+  QTest::addColumn<int>("sampleFormat");
+  QTest::addColumn<int>("channels");
+  QTest::newRow("uint8 stereo") << int(QAudioFormat::UInt8) << 2;
+  QTest::newRow("int16 mono") << int(QAudioFormat::Int16) << 1;
+  QTest::newRow("int32 stereo") << int(QAudioFormat::Int32) << 2;
+  QTest::newRow("float stereo") << int(QAudioFormat::Float) << 2;
+}
+
+// 设备偏好的任何样本格式都能直接输出整帧
+void TestToneSynth::sampleFormats() {
+  QFETCH(int, sampleFormat);
+  QFETCH(int, channels);
+
+  QAudioFormat format;
+  format.setSampleRate(44100);
+  format.setChannelCount(channels);
+  format.setSampleFormat(QAudioFormat::SampleFormat(sampleFormat));
+
+  ToneStream stream(format);
+  stream.open(QIODevice::ReadOnly);
+  const QVector<float> tone(512, 0.5f);
+  stream.enqueue(&tone, 1.0f);
+
+  const int frameBytes = format.bytesPerFrame();
+  QByteArray buffer(frameBytes * 100, '\0');
+  QCOMPARE(stream.read(buffer.data(), buffer.size()), qint64(frameBytes * 100));
+  QVERIFY(stream.lastDequeueDelayNs() >= 0);
+
+  // 第一帧的各声道相同，且为正的半幅值
+  const float first = format.normalizedSampleValue(buffer.constData());
+  QVERIFY(qAbs(first - 0.5f) < 0.02f);
+  const char *second = buffer.constData() + format.bytesPerSample();
+  QCOMPARE(format.normalizedSampleValue(second), first);
+}
+
+QTEST_GUILESS_MAIN(TestToneSynth)
+#include "tst_tone_synth.moc"
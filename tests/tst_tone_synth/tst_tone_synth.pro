@@ -0,0 +1,6 @@
+include(../tests.pri)
+QT += multimedia
+TARGET = tst_tone_synth
+SOURCES += tst_tone_synth.cpp \
+           $$SRC_DIR/tone_synth.cpp
+HEADERS += $$SRC_DIR/tone_synth.h
@@ -0,0 +1,194 @@
+#include "theme_manager.h"
+#include <QApplication>
+#include <QDir>
+#include <QEvent>
+#include <QFile>
+#include <QFileInfo>
+#include <QStyleHints>
+#include <QTimer>
+
+namespace {
+
+// 未登记的窗口上记录已应用的主题（是否深色）
+const char *ThemedProperty = "_pomodoro_themeDark";
+
+} // namespace
+
+ThemeManager::ThemeManager(QObject *parent)
+    : QObject(parent), currentMode(Light), dark(false), switchLatencyUs(-1) {
+  // 浅色主题（基于系统默认调色板）
+  QPalette light = QApplication::palette();
+  light.setColor(QPalette::Window, QColor(240, 240, 240));
+  light.setColor(QPalette::WindowText, Qt::black);
+  light.setColor(QPalette::Base, Qt::white);
+  light.setColor(QPalette::AlternateBase, QColor(233, 233, 233));
+  light.setColor(QPalette::Text, Qt::black);
+  light.setColor(QPalette::Button, QColor(240, 240, 240));
+  light.setColor(QPalette::ButtonText, Qt::black);
+  palettes[0] = light;
+
+  // 深色主题
+  QPalette darkPalette;
+  darkPalette.setColor(QPalette::Window, QColor(43, 43, 43));
+  darkPalette.setColor(QPalette::WindowText, QColor(255, 255, 255));
+  darkPalette.setColor(QPalette::Base, QColor(64, 64, 64));
+  darkPalette.setColor(QPalette::AlternateBase, QColor(53, 53, 53));
+  darkPalette.setColor(QPalette::ToolTipBase, QColor(255, 255, 255));
+  darkPalette.setColor(QPalette::ToolTipText, QColor(43, 43, 43));
+  darkPalette.setColor(QPalette::Text, QColor(255, 255, 255));
+  darkPalette.setColor(QPalette::Button, QColor(64, 64, 64));
+  darkPalette.setColor(QPalette::ButtonText, QColor(255, 255, 255));
+  darkPalette.setColor(QPalette::BrightText, QColor(255, 0, 0));
+  darkPalette.setColor(QPalette::Link, QColor(173, 216, 230));
+  darkPalette.setColor(QPalette::Highlight, QColor(110, 110, 110));
+  darkPalette.setColor(QPalette::HighlightedText, QColor(255, 255, 255));
+  palettes[1] = darkPalette;
+
+  // 样式表只在启动时读取一次：themes/<名称>_light.qss 与 <名称>_dark.qss
+  const QStringList files =
+      QDir(":/themes").entryList(QStringList() << "*.qss", QDir::Files);
+  for (const QString &fileName : files) {
+    QFile file(":/themes/" + fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+      continue;
+    }
+    const QString baseName = QFileInfo(fileName).completeBaseName();
+    const QString content = QString::fromUtf8(file.readAll());
+    if (baseName.endsWith("_dark")) {
+      styles[1].insert(baseName.chopped(5), content);
+    } else if (baseName.endsWith("_light")) {
+      styles[0].insert(baseName.chopped(6), content);
+    }
+  }
+
+  // 对话框和弹出菜单等临时窗口在显示时才能拿到，过滤整个应用的显示事件
+  qApp->installEventFilter(this);
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+  connect(QGuiApplication::styleHints(), &QStyleHints::colorSchemeChanged,
+          this, [this]() {
+            if (currentMode == FollowSystem) {
+              updateTheme();
+            }
+          });
+#endif
+}
+
+bool ThemeManager::canFollowSystem() {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+  return QGuiApplication::styleHints()->colorScheme() !=
+         Qt::ColorScheme::Unknown;
+#else
+  return false;
+#endif
+}
+
+bool ThemeManager::systemPrefersDark() const {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+  return QGuiApplication::styleHints()->colorScheme() == Qt::ColorScheme::Dark;
+#else
+  return false;
+#endif
+}
+
+QString ThemeManager::styleSheet(const QString &styleName) const {
+  return styles[dark ? 1 : 0].value(styleName);
+}
+
+void ThemeManager::registerWindow(QWidget *window, const QString &styleName) {
+  windows.append({window, styleName, false});
+  applyTo(windows.last());
+
+  // 窗口销毁后（例如关闭即删除的提醒对话框）移除登记
+  connect(window, &QObject::destroyed, this, [this](QObject *object) {
+    windows.removeIf([object](const WindowEntry &entry) {
+      return !entry.window || entry.window.data() == object;
+    });
+  });
+}
+
+void ThemeManager::setMode(Mode mode) {
+  currentMode = mode;
+  updateTheme();
+}
+
+void ThemeManager::updateTheme() {
+  // 获取不到系统设置时保持当前的主题，不退回浅色
+  const bool wantDark = currentMode == FollowSystem
+                            ? (canFollowSystem() ? systemPrefersDark() : dark)
+                            : currentMode == Dark;
+  if (wantDark == dark) {
+    return;
+  }
+
+  switchTimer.start();
+  dark = wantDark;
+
+  // 只立即更新可见的窗口，隐藏的窗口在下次显示时再更新
+  for (WindowEntry &entry : windows) {
+    if (!entry.window) {
+      continue;
+    }
+    if (entry.window->isVisible()) {
+      applyTo(entry);
+    } else {
+      entry.stale = true;
+    }
+  }
+  // 正在显示的临时窗口（例如打开着的对话框）也立即更新
+  for (QWidget *window : QApplication::topLevelWidgets()) {
+    if (window->isVisible() && window->property(ThemedProperty).isValid()) {
+      applyToTransient(window);
+    }
+  }
+
+  emit themeChanged(dark);
+
+  // 重绘请求在事件循环中处理，处理完后记录整个切换的耗时
+  QTimer::singleShot(0, this, [this]() {
+    switchLatencyUs = switchTimer.nsecsElapsed() / 1000;
+    qInfo("ThemeManager: 切换到%s主题耗时 %lld us", dark ? "深色" : "浅色",
+          switchLatencyUs);
+  });
+}
+
+void ThemeManager::applyTo(WindowEntry &entry) {
+  entry.stale = false;
+  entry.window->setPalette(palette());
+  if (!entry.styleName.isEmpty()) {
+    entry.window->setStyleSheet(styleSheet(entry.styleName));
+  }
+}
+
+void ThemeManager::applyToTransient(QWidget *window) {
+  if (window->property(ThemedProperty) != QVariant(dark)) {
+    window->setPalette(palette());
+    window->setProperty(ThemedProperty, dark);
+  }
+}
+
+bool ThemeManager::eventFilter(QObject *watched, QEvent *event) {
+  if (event->type() != QEvent::Show || !watched->isWidgetType()) {
+    return QObject::eventFilter(watched, event);
+  }
+  QWidget *window = static_cast<QWidget *>(watched);
+  if (!window->isWindow()) {
+    return QObject::eventFilter(watched, event);
+  }
+
+  for (WindowEntry &entry : windows) {
+    if (entry.window == window) {
+      if (entry.stale) {
+        applyTo(entry);
+      }
+      return QObject::eventFilter(watched, event);
+    }
+  }
+  // 调色板不会传给子窗口，未登记的窗口在显示时单独应用；
+  // 自己设置了调色板的窗口（例如浮动窗口）保持不变
+  if (!window->testAttribute(Qt::WA_SetPalette) ||
+      window->property(ThemedProperty).isValid()) {
+    applyToTransient(window);
+  }
+  return QObject::eventFilter(watched, event);
+}
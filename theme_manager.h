@@ -0,0 +1,66 @@
+#ifndef THEME_MANAGER_H
+#define THEME_MANAGER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPalette>
+#include <QPointer>
+#include <QWidget>
+
+// 主题管理：启动时预先生成深浅两套调色板并加载样式表资源，
+// 切换时只更新已注册的窗口，不修改全局调色板，避免整个应用重新polish。
+// 没有登记的顶层窗口（对话框、托盘菜单、下拉列表等）在显示时采用当前调色板
+class ThemeManager : public QObject {
+  Q_OBJECT
+
+public:
+  enum Mode { Light, Dark, FollowSystem };
+
+  // 能否获取系统的深浅色设置（需要Qt 6.5，并且平台报告了配色方案）
+  static bool canFollowSystem();
+
+  explicit ThemeManager(QObject *parent = nullptr);
+
+  // 注册需要跟随主题的顶层窗口，styleName为空时只应用调色板
+  void registerWindow(QWidget *window, const QString &styleName = QString());
+
+  void setMode(Mode mode);
+  Mode mode() const { return currentMode; }
+  bool isDark() const { return dark; }
+
+  const QPalette &palette() const { return palettes[dark ? 1 : 0]; }
+  QString styleSheet(const QString &styleName) const;
+
+  // 最近一次主题切换的耗时（微秒），从切换开始到重绘请求处理完毕
+  qint64 lastSwitchLatencyUs() const { return switchLatencyUs; }
+
+signals:
+  void themeChanged(bool dark);
+
+protected:
+  bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+  struct WindowEntry {
+    QPointer<QWidget> window;
+    QString styleName;
+    bool stale; // 隐藏时主题发生了变化，显示时再应用
+  };
+
+  bool systemPrefersDark() const;
+  void updateTheme();
+  void applyTo(WindowEntry &entry);
+  void applyToTransient(QWidget *window);
+
+  QPalette palettes[2];              // 0 浅色，1 深色
+  QHash<QString, QString> styles[2]; // 预加载的样式表
+  QList<WindowEntry> windows;
+  Mode currentMode;
+  bool dark;
+  QElapsedTimer switchTimer;
+  qint64 switchLatencyUs;
+};
+
+#endif // THEME_MANAGER_H
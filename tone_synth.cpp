@@ -0,0 +1,228 @@
+#include "tone_synth.h"
+#include <QAudioSink>
+#include <QMediaDevices>
+#include <QMutexLocker>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+
+// 在样本缓冲中叠加一个带泛音和指数衰减包络的音符
+void addNote(QVector<float> &samples, int sampleRate, double startSec,
+             double frequency, double durationSec, float amplitude) {
+  const qsizetype start = static_cast<qsizetype>(startSec * sampleRate);
+  const qsizetype length = static_cast<qsizetype>(durationSec * sampleRate);
+  if (samples.size() < start + length) {
+    samples.resize(start + length, 0.0f);
+  }
+
+  const double attack = 0.004 * sampleRate; // 4ms起音，避免爆音
+  const double decay = durationSec * sampleRate / 5.0;
+  for (qsizetype i = 0; i < length; ++i) {
+    const double t = static_cast<double>(i) / sampleRate;
+    const double envelope =
+        std::min(1.0, i / attack) * qExp(-static_cast<double>(i) / decay);
+    const double phase = 2.0 * M_PI * frequency * t;
+    const double value = qSin(phase) + 0.3 * qSin(2.0 * phase) +
+                         0.1 * qSin(3.0 * phase); // 少量泛音让声音更像钟声
+    samples[start + i] += static_cast<float>(amplitude * envelope * value);
+  }
+}
+
+// 把单声道混音结果写成设备的样本格式，所有声道输出同一信号
+template <typename Sample, typename Convert>
+void writeFrames(char *data, const float *mix, qsizetype frames, int channels,
+                 Convert convert) {
+  Sample *out = reinterpret_cast<Sample *>(data);
+  for (qsizetype f = 0; f < frames; ++f) {
+    const Sample value = convert(std::clamp(mix[f], -1.0f, 1.0f));
+    for (int c = 0; c < channels; ++c) {
+      *out++ = value;
+    }
+  }
+}
+
+} // namespace
+
+ToneStream::ToneStream(const QAudioFormat &format, QObject *parent)
+    : QIODevice(parent), outputFormat(format), voiceCount(0),
+      dequeueDelayNs(-1) {
+  // 预分配约100ms的混音缓冲，正常情况下音频线程不会再分配内存
+  mixBuffer.resize(format.framesForDuration(100000));
+  clock.start();
+}
+
+void ToneStream::enqueue(const QVector<float> *samples, float gain) {
+  QMutexLocker locker(&mutex);
+  Voice voice{samples, 0, gain, clock.nsecsElapsed()};
+
+  if (voiceCount < MaxVoices) {
+    voices[voiceCount++] = voice;
+    return;
+  }
+
+  // 发声数已满时替换播放进度最靠后的提示音
+  int oldest = 0;
+  for (int i = 1; i < voiceCount; ++i) {
+    if (voices[i].offset > voices[oldest].offset) {
+      oldest = i;
+    }
+  }
+  voices[oldest] = voice;
+}
+
+qint64 ToneStream::bytesAvailable() const {
+  // 流永不结束：没有提示音时提供静音
+  return outputFormat.bytesForDuration(20000) + QIODevice::bytesAvailable();
+}
+
+qint64 ToneStream::readData(char *data, qint64 maxlen) {
+  const int bytesPerFrame = outputFormat.bytesPerFrame();
+  const qsizetype frames = maxlen / bytesPerFrame;
+  if (frames <= 0) {
+    return 0;
+  }
+
+  QMutexLocker locker(&mutex);
+  if (mixBuffer.size() < frames) {
+    mixBuffer.resize(frames);
+  }
+  float *mix = mixBuffer.data();
+  std::fill_n(mix, frames, 0.0f);
+
+  const qint64 now = clock.nsecsElapsed();
+  for (int i = 0; i < voiceCount;) {
+    Voice &voice = voices[i];
+    if (voice.offset == 0) {
+      dequeueDelayNs.store(now - voice.queuedAtNs);
+    }
+
+    const float *source = voice.samples->constData() + voice.offset;
+    const qsizetype count =
+        std::min(frames, voice.samples->size() - voice.offset);
+    for (qsizetype k = 0; k < count; ++k) {
+      mix[k] += source[k] * voice.gain;
+    }
+    voice.offset += count;
+
+    if (voice.offset >= voice.samples->size()) {
+      voices[i] = voices[--voiceCount]; // 播放完毕，移除
+    } else {
+      ++i;
+    }
+  }
+  locker.unlock();
+
+  // 转换为设备格式（所有声道输出同一单声道信号）
+  const int channels = outputFormat.channelCount();
+  switch (outputFormat.sampleFormat()) {
+  case QAudioFormat::Float:
+    writeFrames<float>(data, mix, frames, channels,
+                       [](float v) { return v; });
+    break;
+  case QAudioFormat::Int32:
+    writeFrames<qint32>(data, mix, frames, channels, [](float v) {
+      return static_cast<qint32>(double(v) * 2147483647.0);
+    });
+    break;
+  case QAudioFormat::UInt8:
+    writeFrames<quint8>(data, mix, frames, channels, [](float v) {
+      return static_cast<quint8>(128.0f + v * 127.0f);
+    });
+    break;
+  default:
+    writeFrames<qint16>(data, mix, frames, channels, [](float v) {
+      return static_cast<qint16>(v * 32767.0f);
+    });
+    break;
+  }
+
+  return frames * bytesPerFrame;
+}
+
+qint64 ToneStream::writeData(const char *data, qint64 len) {
+  Q_UNUSED(data)
+  Q_UNUSED(len)
+  return -1;
+}
+
+ToneSynth::ToneSynth(QObject *parent)
+    : ToneSynth(QMediaDevices::defaultAudioOutput(), parent) {}
+
+ToneSynth::ToneSynth(const QAudioDevice &device, QObject *parent)
+    : QObject(parent), toneStream(nullptr), sink(nullptr) {
+  setupOutput(device);
+  buildChimes();
+}
+
+ToneSynth::~ToneSynth() {
+  if (sink) {
+    sink->stop();
+  }
+}
+
+void ToneSynth::setupOutput(const QAudioDevice &device) {
+  // 默认格式：48kHz 单声道 16位
+  format.setSampleRate(48000);
+  format.setChannelCount(1);
+  format.setSampleFormat(QAudioFormat::Int16);
+
+  if (!device.isNull() && !device.isFormatSupported(format)) {
+    // 直接使用设备偏好的格式，混音流负责转换成它的样本格式
+    format = device.preferredFormat();
+  }
+
+  toneStream = new ToneStream(format, this);
+  toneStream->open(QIODevice::ReadOnly);
+
+  if (device.isNull()) {
+    qWarning("ToneSynth: 没有可用的音频输出设备，提示音将不会播放");
+    return;
+  }
+
+  // 常驻输出，使用很小的设备缓冲（约10ms）以降低提示音的启动延迟
+  sink = new QAudioSink(device, format, this);
+  sink->setBufferSize(format.bytesForDuration(10000));
+  sink->start(toneStream);
+}
+
+void ToneSynth::buildChimes() {
+  const int rate = format.sampleRate();
+
+  // 工作结束：柔和的下行三音 G5-E5-C5，重复两次
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    const double offset = repeat * 0.9;
+    addNote(chimes[WorkEnd], rate, offset + 0.00, 783.99, 0.6, 0.30f);
+    addNote(chimes[WorkEnd], rate, offset + 0.18, 659.25, 0.6, 0.30f);
+    addNote(chimes[WorkEnd], rate, offset + 0.36, 523.25, 0.8, 0.30f);
+  }
+
+  // 休息结束：明快的上行三音 C5-E5-G5-C6，重复两次
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    const double offset = repeat * 0.8;
+    addNote(chimes[BreakEnd], rate, offset + 0.00, 523.25, 0.4, 0.28f);
+    addNote(chimes[BreakEnd], rate, offset + 0.12, 659.25, 0.4, 0.28f);
+    addNote(chimes[BreakEnd], rate, offset + 0.24, 783.99, 0.4, 0.28f);
+    addNote(chimes[BreakEnd], rate, offset + 0.36, 1046.50, 0.6, 0.28f);
+  }
+
+  // 即将结束：两声短促的A5提示
+  addNote(chimes[Warning], rate, 0.00, 880.0, 0.15, 0.25f);
+  addNote(chimes[Warning], rate, 0.22, 880.0, 0.15, 0.25f);
+}
+
+void ToneSynth::play(Chime chime, float volume) {
+  if (chime < 0 || chime >= ChimeCount || volume <= 0.0f) {
+    return;
+  }
+  toneStream->enqueue(&chimes[chime], volume);
+}
+
+qint64 ToneSynth::lastLatencyUs() const {
+  const qint64 delayNs = toneStream->lastDequeueDelayNs();
+  if (delayNs < 0) {
+    return -1;
+  }
+  const qint64 bufferUs = sink ? format.durationForBytes(sink->bufferSize()) : 0;
+  return delayNs / 1000 + bufferUs;
+}
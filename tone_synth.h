@@ -0,0 +1,86 @@
+#ifndef TONE_SYNTH_H
+#define TONE_SYNTH_H
+
+#include <QAudioDevice>
+#include <QAudioFormat>
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+#include <atomic>
+
+class QAudioSink;
+
+// 提示音混音流：音频设备以拉取模式从这里读取数据，
+// 没有提示音时输出静音，保证输出设备一直处于活动状态，避免重新启动的延迟
+class ToneStream : public QIODevice {
+  Q_OBJECT
+
+public:
+  explicit ToneStream(const QAudioFormat &format, QObject *parent = nullptr);
+
+  void enqueue(const QVector<float> *samples, float gain);
+  qint64 lastDequeueDelayNs() const { return dequeueDelayNs.load(); }
+
+  bool isSequential() const override { return true; }
+  qint64 bytesAvailable() const override;
+
+protected:
+  qint64 readData(char *data, qint64 maxlen) override;
+  qint64 writeData(const char *data, qint64 len) override;
+
+private:
+  struct Voice {
+    const QVector<float> *samples;
+    qsizetype offset;
+    float gain;
+    qint64 queuedAtNs;
+  };
+
+  static constexpr int MaxVoices = 8; // 同时发声的提示音上限（固定容量，不分配内存）
+
+  QAudioFormat outputFormat;
+  QMutex mutex;
+  Voice voices[MaxVoices];
+  int voiceCount;
+  QVector<float> mixBuffer; // 预分配的混音缓冲，避免在音频线程中分配内存
+  QElapsedTimer clock;
+  std::atomic<qint64> dequeueDelayNs;
+};
+
+// 内置提示音合成器：启动时预先计算好各类提示音的PCM数据，
+// 通过常驻的QAudioSink播放，不依赖任何外部声音文件
+class ToneSynth : public QObject {
+  Q_OBJECT
+
+public:
+  enum Chime {
+    WorkEnd,  // 工作结束，开始休息
+    BreakEnd, // 休息结束，开始工作
+    Warning,  // 阶段即将结束
+    ChimeCount
+  };
+
+  explicit ToneSynth(QObject *parent = nullptr);
+  // 传入空设备时不创建输出，仅生成混音流（可用于测量延迟）
+  ToneSynth(const QAudioDevice &device, QObject *parent = nullptr);
+  ~ToneSynth();
+
+  void play(Chime chime, float volume);
+
+  ToneStream *stream() const { return toneStream; }
+  // 从调用play()到提示音开始输出的延迟（微秒），包含设备缓冲时长
+  qint64 lastLatencyUs() const;
+
+private:
+  void setupOutput(const QAudioDevice &device);
+  void buildChimes();
+
+  QAudioFormat format;
+  QVector<float> chimes[ChimeCount];
+  ToneStream *toneStream;
+  QAudioSink *sink;
+};
+
+#endif // TONE_SYNTH_H